@@ -18,6 +18,9 @@ void Action::goto_tab(int index)
 
 void Action::goto_tab1() { Action::goto_tab(0); }
 void Action::goto_tab2() { Action::goto_tab(1); }
+void Action::goto_tab3() { Action::goto_tab(2); }
+void Action::goto_tab4() { Action::goto_tab(3); }
+void Action::goto_tab5() { Action::goto_tab(4); }
 
 void Action::goto_filter()
 {
@@ -26,6 +29,16 @@ void Action::goto_filter()
     ui->filterInput->deselect();
 }
 
+/**
+ * switch to the next filter mode (regex -> fuzzy -> ...)
+ */
+void Action::cycle_filter_mode()
+{
+    Action::goto_filter();
+    const int count = ui->filterMode->count();
+    ui->filterMode->setCurrentIndex((ui->filterMode->currentIndex() + 1) % count);
+}
+
 void Action::goto_date_fr()
 {
     Action::goto_tab1();
@@ -47,6 +60,15 @@ void Action::goto_text()
     case 1:
         ui->spentText->setFocus(Qt::ShortcutFocusReason);
         break;
+    case 2:
+        ui->heatmapText->setFocus(Qt::ShortcutFocusReason);
+        break;
+    case 3:
+        ui->topText->setFocus(Qt::ShortcutFocusReason);
+        break;
+    case 4:
+        ui->intervalText->setFocus(Qt::ShortcutFocusReason);
+        break;
     default:
         qDebug() << "Tab without Ctrl+t shortcut! index:"
                  << ui->tabWidget->currentIndex();
@@ -61,3 +83,37 @@ void Action::toggle_merge()
     ui->checkBoxMerge->click();
 }
 
+void Action::toggle_near()
+{
+    if (ui->tabWidget->currentIndex() != 1)
+        return;
+    ui->checkBoxNear->click();
+}
+
+/**
+ * sort the spent view by the next key (file -> duration -> ...)
+ */
+void Action::cycle_sort()
+{
+    if (ui->tabWidget->currentIndex() != 1)
+        return;
+    const int count = ui->sortMode->count();
+    ui->sortMode->setCurrentIndex((ui->sortMode->currentIndex() + 1) % count);
+}
+
+void Action::toggle_sort_order()
+{
+    if (ui->tabWidget->currentIndex() != 1)
+        return;
+    ui->checkBoxDesc->click();
+}
+
+void Action::toggle_live()
+{
+    ui->checkBoxLive->click();
+}
+
+void Action::toggle_mem()
+{
+    ui->memText->setVisible(!ui->memText->isVisible());
+}
@@ -19,11 +19,20 @@ private:
 public slots:
     void goto_tab1();
     void goto_tab2();
+    void goto_tab3();
+    void goto_tab4();
+    void goto_tab5();
     void goto_filter();
+    void cycle_filter_mode();
     void goto_date_fr();
     void goto_date_to();
     void goto_text();
     void toggle_merge();
+    void toggle_near();
+    void cycle_sort();
+    void toggle_sort_order();
+    void toggle_live();
+    void toggle_mem();
 
 private:
     Ui::MainWindow *ui;
@@ -0,0 +1,150 @@
+#include <filesystem>
+#include <regex>
+#include <string>
+#include <utility>   // move
+#include <vector>
+
+#include "api.hpp"
+#include "attila.hpp"
+#include "cal.hpp"     // ISO week calendar
+#include "query.hpp"   // query namespace
+#include "stats.hpp"
+
+namespace fs = std::filesystem;
+
+api::result_t api::result_t::failed(std::string err)
+{
+    api::result_t r;
+    r.err = std::move(err);
+    return r;
+}
+
+ss::vtasks_t::const_iterator api::result_t::begin() const
+{
+    static const ss::vtasks_t none;
+    return (tasks) ? tasks->begin() : none.begin();
+}
+
+ss::vtasks_t::const_iterator api::result_t::end() const
+{
+    static const ss::vtasks_t none;
+    return (tasks) ? tasks->end() : none.begin();
+}
+
+api::result_t api::result_t::filter(const std::string &query) const
+{
+    if (!ok())
+        return *this;
+    query::filter_t qf(query);
+    if (!qf.ok())
+        return failed("not valid query: " + qf.error());
+    if (!tasks)
+        return *this;
+    return { span, std::make_shared<const ss::vtasks_t>(qf.filter(*tasks)) };
+}
+
+api::result_t api::result_t::grep(const std::string &regex) const
+{
+    if (!ok())
+        return *this;
+    const std::string error = filter_error(regex);
+    if (!error.empty())
+        return failed("not valid regex: " + error);
+    if (!tasks)
+        return *this;
+    try {
+        return { span, std::make_shared<const ss::vtasks_t>(filter_tasks(*tasks, regex)) };
+    } catch (const std::regex_error &e) {
+        return failed("regex failed: " + std::string(e.what()));
+    }
+}
+
+std::optional<ss::stats_t> api::result_t::stats() const
+{
+    if (empty())
+        return std::nullopt;
+    return calculate_stats(*tasks);
+}
+
+ss::heatmap_t api::result_t::heatmap(std::size_t bucket_min) const
+{
+    return calculate_heatmap((tasks) ? *tasks : ss::vtasks_t {}, bucket_min);
+}
+
+std::vector<std::size_t> api::result_t::longest(std::size_t k) const
+{
+    return (tasks) ? topk::longest(*tasks, k) : std::vector<std::size_t> {};
+}
+
+std::vector<topk::group_t> api::result_t::projects(std::size_t k) const
+{
+    return (tasks) ? topk::projects(*tasks, k) : std::vector<topk::group_t> {};
+}
+
+std::vector<topk::group_t> api::result_t::texts(std::size_t k) const
+{
+    return (tasks) ? topk::texts(*tasks, k) : std::vector<topk::group_t> {};
+}
+
+const std::string &api::result_t::text() const
+{
+    static const std::string none;
+    return (span) ? span->content : none;
+}
+
+const std::vector<std::string> &api::result_t::files() const
+{
+    static const std::vector<std::string> none;
+    return (span) ? span->fpaths : none;
+}
+
+const diag::log_t &api::result_t::diag() const
+{
+    static const diag::log_t none;
+    return (span) ? span->diag : none;
+}
+
+api::archive_t::archive_t(std::vector<std::string> roots)
+    : roots_((roots.empty()) ? find_task_roots() : std::move(roots))
+{
+    if (roots_.empty()) {
+        err = "no task directories: set $POMODORO_DIRS or $POMODORO_DIR";
+        return;
+    }
+    for (const auto &root : roots_) {
+        if (!fs::is_directory(root)) {
+            err = "task directory not found: '" + root + "'";
+            return;
+        }
+    }
+}
+
+std::vector<std::string> api::archive_t::files(const std::string &fr, const std::string &to) const
+{
+    std::vector<std::string> fpaths;
+    if (!ok())
+        return fpaths;
+    for (const auto &root : roots_) {
+        const std::vector<std::string> root_fpaths = find_week_files_in_span(root, fr, to);
+        fpaths.insert(fpaths.end(), root_fpaths.begin(), root_fpaths.end());
+    }
+    return fpaths;
+}
+
+api::result_t api::archive_t::span(const std::string &fr, const std::string &to, const api::chunk_fn_t &chunk) const
+{
+    if (!ok())
+        return api::result_t::failed(err);
+    cal::date_t d_fr {}, d_to {};
+    if (!cal::parse_date(fr, d_fr) || !cal::parse_date(to, d_to))
+        return api::result_t::failed("not valid span: '" + fr + "' -> '" + to + "' (YYYY-MM-DD)");
+    const bool swapped = to < fr;
+    progress_fn_t progress;
+    if (chunk)
+        progress = [&chunk](std::size_t, std::size_t, const ss::vtasks_t &vtt) { chunk(vtt); };
+    auto span = std::make_shared<const ss::span_t>(
+        load_span(roots_, (swapped) ? to : fr, (swapped) ? fr : to, progress));
+    // tasks of the result are the tasks of the span (aliasing -> no copy)
+    std::shared_ptr<const ss::vtasks_t> tasks(span, &span->vtt);
+    return { std::move(span), std::move(tasks) };
+}
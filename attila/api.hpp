@@ -0,0 +1,115 @@
+#ifndef API_HPP
+#define API_HPP
+
+#include <cstddef> // size_t
+#include <functional>
+#include <memory>  // shared_ptr
+#include <optional>
+#include <string>
+#include <utility> // move
+#include <vector>
+
+#include "structs.hpp" // ss namespace with struct defs
+#include "diag.hpp"    // parse diagnostics
+#include "topk.hpp"    // topk::group_t
+
+namespace api
+{
+    /**
+     * embeddable API of the analysis core (attila_core library, no Qt):
+     *   api::archive_t archive({ "/home/me/pomodoro" });
+     *   api::result_t r = archive.span("2022-01-01", "2022-12-31").filter("p:nvim duration>30m");
+     *   for (api::cursor_t c = r.cursor(); const ss::task_t *t = c.next(); )
+     *       ...
+     *   std::optional<ss::stats_t> s = r.stats();
+     * results share the parsed span (tasks & text are not copied or formatted),
+     * a filtered result holds only the tasks it selected.
+     * errors are returned as values: ok() / error() of the archive & of the results.
+     */
+
+    /**
+     * lazy iteration over the tasks of the result (keeps the result alive)
+     */
+    class cursor_t {
+    public:
+        explicit cursor_t(std::shared_ptr<const ss::vtasks_t> tasks) : tasks(std::move(tasks)) {}
+
+        const ss::task_t *next() { return (tasks && pos < tasks->size()) ? &(*tasks)[pos++] : nullptr; }
+        std::size_t remaining() const { return (tasks) ? tasks->size() - pos : 0; }
+
+    private:
+        std::shared_ptr<const ss::vtasks_t> tasks;
+        std::size_t pos {0};
+    };
+
+    class result_t {
+    public:
+        result_t() = default;
+
+        bool ok() const { return err.empty(); }
+        const std::string &error() const { return err; }
+
+        std::size_t size() const { return (tasks) ? tasks->size() : 0; }
+        bool empty() const { return size() == 0; }
+        const ss::task_t &operator[](std::size_t i) const { return (*tasks)[i]; }
+        api::cursor_t cursor() const { return api::cursor_t(tasks); }
+        ss::vtasks_t::const_iterator begin() const;
+        ss::vtasks_t::const_iterator end() const;
+
+        api::result_t filter(const std::string &query) const; // structured query, see query.hpp
+        api::result_t grep(const std::string &regex) const;   // regex over the task lines (case insensitive)
+
+        // aggregates of the tasks of the result
+        std::optional<ss::stats_t> stats() const; // none if there are no tasks
+        ss::heatmap_t heatmap(std::size_t bucket_min = 60) const;
+        std::vector<std::size_t>   longest(std::size_t k) const;  // indices into this result
+        std::vector<topk::group_t> projects(std::size_t k) const; // most time spent
+        std::vector<topk::group_t> texts(std::size_t k) const;    // most frequent
+
+        // of the whole span the result was selected from
+        const std::string &text() const;                // concatenated week files
+        const std::vector<std::string> &files() const;  // week files
+        const diag::log_t &diag() const;                // lines which are not tasks
+
+    private:
+        friend class archive_t;
+        result_t(std::shared_ptr<const ss::span_t> span, std::shared_ptr<const ss::vtasks_t> tasks)
+            : span(std::move(span)), tasks(std::move(tasks)) {}
+        static api::result_t failed(std::string err);
+
+    private:
+        std::shared_ptr<const ss::span_t>   span;
+        std::shared_ptr<const ss::vtasks_t> tasks;
+        std::string err {};
+    };
+
+    /**
+     * tasks of a parsed week file of the span being loaded (in any order, called from the parsing threads)
+     */
+    using chunk_fn_t = std::function<void(const ss::vtasks_t &tasks)>;
+
+    /**
+     * task directories (roots): week files are found in the roots & merged into one timeline
+     */
+    class archive_t {
+    public:
+        explicit archive_t(std::vector<std::string> roots = {}); // none -> $POMODORO_DIRS / $POMODORO_DIR
+
+        bool ok() const { return err.empty(); }
+        const std::string &error() const { return err; }
+        const std::vector<std::string> &roots() const { return roots_; }
+
+        std::vector<std::string> files(const std::string &fr, const std::string &to) const;
+        /**
+         * load & parse the span of dates (YYYY-MM-DD, inclusive),
+         * chunk (if any) gets the tasks of every week file as soon as it was parsed
+         */
+        api::result_t span(const std::string &fr, const std::string &to, const api::chunk_fn_t &chunk = {}) const;
+
+    private:
+        std::vector<std::string> roots_;
+        std::string err {};
+    };
+}
+
+#endif // API_HPP
@@ -5,15 +5,21 @@
 #include <sstream>
 
 #include <algorithm>
-#include <future>   // async
-#include <thread>   // hardware_concurrency
+#include <atomic>   // atomic<bool> cancellation token
+#include <cstdint>  // uint16_t
+#include <cstdlib>  // getenv
+#include <functional> // greater, function
+#include <future>   // future (reading of the files)
+#include <limits>
+#include <optional>
+#include <queue>    // priority_queue
 
 #include <filesystem>
 #include <regex>
+#include <set>
 #include <string>
+#include <string_view>
 #include <vector>
-#include <locale>
-#include <iomanip>  // put_time
 
 #include <fmt/core.h>
 #include <fmt/format.h> // fmt::join
@@ -21,7 +27,14 @@
 #include "attila.hpp"
 
 #include "structs.hpp"  // ss  namespace with struct defs
+#include "cal.hpp"      // ISO week calendar
 #include "str.hpp"      // str namespace
+#include "io.hpp"       // io  namespace
+#include "lines.hpp"    // line-offset table
+#include "dfa.hpp"      // linear time regex matcher
+#include "mem.hpp"      // heap accounting per stage
+#include "diag.hpp"     // parse diagnostics
+#include "exec.hpp"     // shared thread pool
 
 namespace fs = std::filesystem;
 
@@ -36,6 +49,19 @@ std::vector<int> split_vi(const std::string &s, char delimiter)
     return tokens;
 }
 
+/**
+ * date string (YYYY-MM-DD) into the broken-down time, not valid date leaves it as it is
+ */
+static void set_tm_date(const std::string &date_str, std::tm &tm)
+{
+    cal::date_t d {};
+    if (!cal::parse_date(date_str, d))
+        return;
+    tm.tm_year = d.year - 1900;
+    tm.tm_mon  = d.month - 1;
+    tm.tm_mday = d.day;
+}
+
 const ss::hm_t calculate_time_spent(
         const std::string &d_fr, const std::string &d_to,
         const std::string &t_fr, const std::string &t_to
@@ -51,15 +77,13 @@ const ss::hm_t calculate_time_spent(
 #endif
 
     std::tm t1 {};
-    std::istringstream t1s(d_fr);
-    t1s >> std::get_time(&t1, str::datef); // date from string
+    set_tm_date(d_fr, t1); // date from string
     t1.tm_hour = fr_res[0];
     t1.tm_min  = fr_res[1];
     std::time_t beg = std::mktime(&t1);    // sec since epoch
 
     std::tm t2 {};
-    std::istringstream t2s(d_to);
-    t2s >> std::get_time(&t2, str::datef);
+    set_tm_date(d_to, t2);
     t2.tm_hour = to_res[0];
     t2.tm_min  = to_res[1];
     std::time_t end = std::mktime(&t2);
@@ -76,32 +100,26 @@ const ss::hm_t calculate_time_spent(
     return {t1, t2, beg, end, diff, d_fr, d_to, t_fr, t_to, str::sec_to_tstr(diff)};
 }
 
-const ss::hm_t time_spent(const std::string &s)
+/**
+ * time spent by the date & time span string, nothing if the date and/or time span is not found
+ */
+std::optional<ss::hm_t> time_spent(const std::string &s)
 {
     std::smatch m;
-    if(!std::regex_search(s, m, str::dts_re)) {
-        try {
-            throw "date and/or time span was not found in the string";
-        } catch (const char* e) {
-            std::cerr << "[Warning]: " << e << std::endl;
-            throw;
-        }
-    }
+    if (!std::regex_search(s, m, str::dts_re))
+        return std::nullopt;
     return calculate_time_spent(m[1], m[1], m[2], m[3]);
 }
 
-const std::pair<const std::string, const std::string> dts_and_task(const std::string &s)
+/**
+ * date & time span and the task text of the line, nothing if the line is not a task
+ */
+std::optional<std::pair<std::string, std::string>> dts_and_task(const std::string &s)
 {
     std::smatch m;
-    if(!std::regex_search(s, m, str::dts_txt_re)) {
-        try {
-            throw "time span and/or task text was not found in the string";
-        } catch (const char* e) {
-            std::cerr << "[Warning]: " << e << std::endl;
-            throw;
-        }
-    }
-    return std::make_pair(m[1], m[4]);
+    if (!std::regex_search(s, m, str::dts_txt_re))
+        return std::nullopt;
+    return std::make_pair(m.str(1), m.str(4));
 }
 
 std::vector<std::string> projects_of_task(const std::string &s)
@@ -115,34 +133,36 @@ std::vector<std::string> projects_of_task(const std::string &s)
 }
 
 /**
- * parse/analyze multiline string of tasks
+ * parse/analyze lines [beg_nl, end_nl) of multiline string of tasks
  */
-ss::vtasks_t parse_tasks(const std::string &s)
+ss::vtasks_t parse_tasks(std::string_view s, const lines::index_t &idx,
+                         std::size_t beg_nl, std::size_t end_nl, diag::log_t *log)
 {
+    const mem::scope_t mscope(mem::stage_t::PARSE);
     ss::vtasks_t tasks;
     std::string line;
-    std::istringstream content(s);
-    std::pair<std::string, std::string> dts_text {};
-    ss::hm_t hm_t {};
-    std::string skip_msg = "^ Skipping task due to previous exception with line: ";
-    while (std::getline(content, line)) {
-        try {
-            dts_text = dts_and_task(line);
-        } catch (const char* e) {
-            std::cerr << "[Info]: " << skip_msg << "'" << line << "'" << std::endl;
-            continue; // safely handle exception by skipping this task
+    for (std::size_t nl = beg_nl; nl < end_nl; nl++) {
+        line = idx.line(s, nl);
+        if (line.find_first_not_of(" \t\r") == std::string::npos)
+            continue; // blank lines are not diagnosed
+        // lines which are not tasks are skipped & reported into the log (if any)
+        std::optional<std::pair<std::string, std::string>> dts_text = dts_and_task(line);
+        if (!dts_text) {
+            if (log)
+                log->add(nl, diag::reason_t::NO_TASK);
+            continue;
         }
-        std::string &dts  = dts_text.first;
-        std::string &text = dts_text.second;
-        try {
-            hm_t = time_spent(dts);
-        } catch (const char* e) {
-            std::cerr << "[Info]: " << skip_msg << "'" << line << "'" << std::endl;
-            continue; // safely handle exception by skipping this task
+        std::string &dts  = dts_text->first;
+        std::string &text = dts_text->second;
+        std::optional<ss::hm_t> hm_t = time_spent(dts);
+        if (!hm_t) {
+            if (log)
+                log->add(nl, diag::reason_t::NO_TIME_SPAN);
+            continue;
         }
         std::vector<std::string> words = str::split_on_words(text);
         std::vector<std::string> tproj = projects_of_task(text);
-        ss::task_t task = {dts, text, hm_t, words, tproj};
+        ss::task_t task = {dts, text, *hm_t, words, tproj};
         tasks.push_back(task);
     }
 #if 0
@@ -160,43 +180,50 @@ ss::vtasks_t parse_tasks(const std::string &s)
 }
 
 /**
- * wrapper around parse_tasks() for parallel/async parsing/analyzing of multiline string
+ * parse/analyze multiline string of tasks
  */
-ss::vtasks_t parse_tasks_parallel(const std::string &s)
+ss::vtasks_t parse_tasks(const std::string &s, diag::log_t *log)
 {
-    size_t nl = std::count(s.begin(), s.end(), '\n'); // new lines count
-    size_t threads_total = std::thread::hardware_concurrency();
+    const lines::index_t idx = lines::build_index(s);
+    return parse_tasks(s, idx, 0, idx.count(), log);
+}
+
+/**
+ * wrapper around parse_tasks() for parallel/async parsing/analyzing of multiline string.
+ * chunks of lines are taken straight from the line-offset table (without copying the lines).
+ */
+ss::vtasks_t parse_tasks_parallel(std::string_view s, const lines::index_t &idx, diag::log_t *log)
+{
+    const size_t nl = idx.count(); // lines count
+    size_t threads_total = exec::workers();
     if (threads_total < 2 || nl < 101) { // simple single threaded mode
-        return parse_tasks(s);
+        return parse_tasks(s, idx, 0, nl, log);
     }
     size_t num_threads = threads_total - 1; // -1 thread is essential for the algorithm
-    // fill the lines vector
-    std::string line;
-    std::vector<std::string> lines;
-    std::istringstream content(s);
-    while (std::getline(content, line))
-        lines.push_back(line);
     // lines per thread (-1 thread) & remainder
     size_t lpt = nl / num_threads;
-    double lpt_remainder = nl % num_threads;
+    size_t lpt_remainder = nl % num_threads;
     // lambda function for feeding the tasks analyzer
     // with equally distributed chunks-lines of one large text
+    // each thread reports into its own log, logs are merged in the order of the chunks
+    std::vector<diag::log_t> logs(num_threads + 1, (log) ? log->fork() : diag::log_t {});
     auto parse_tasks_lines = [&](size_t i, bool to_the_end=false) -> ss::vtasks_t {
+        diag::log_t *tlog = (log) ? &logs[i] : nullptr;
         if (to_the_end)
-            return parse_tasks(str::lines_between(lines, lpt*i, -1));
+            return parse_tasks(s, idx, lpt*i, nl, tlog);
         else
-            return parse_tasks(str::lines_between(lines, lpt*i, lpt*(i+1)));
+            return parse_tasks(s, idx, lpt*i, lpt*(i+1), tlog);
     };
     // vector of futures which will contain vector of task structs
-    std::vector<std::future<ss::vtasks_t>> futures;
+    std::vector<exec::future_t<ss::vtasks_t>> futures;
     for (size_t i = 0; i < num_threads; i++) {
         futures.insert(futures.begin() + i,
-                std::async(std::launch::async, parse_tasks_lines, i));
+                exec::async(parse_tasks_lines, i, false));
     }
     // if has remainder -> process leftover lines on additional (last thread)
     if (lpt_remainder != 0) {
         futures.insert(futures.begin() + num_threads,
-                std::async(std::launch::async, parse_tasks_lines, num_threads, true));
+                exec::async(parse_tasks_lines, num_threads, true));
     }
     // extend vector with tasks_t vectors got from vector of futures
     ss::vtasks_t vtt;
@@ -204,9 +231,17 @@ ss::vtasks_t parse_tasks_parallel(const std::string &s)
         ss::vtasks_t tmp_vec = e.get();
         vtt.insert(vtt.end(), tmp_vec.begin(), tmp_vec.end());
     }
+    if (log)
+        for (const auto &l : logs)
+            log->merge(l);
     return vtt;
 }
 
+ss::vtasks_t parse_tasks_parallel(const std::string &s, diag::log_t *log)
+{
+    return parse_tasks_parallel(s, lines::build_index(s), log);
+}
+
 std::vector<std::string> get_all_files_recursive(const fs::path &path)
 {
     std::vector<std::string> fpaths;
@@ -225,17 +260,71 @@ std::vector<std::string> get_all_files_recursive(const fs::path &path)
     return fpaths;
 }
 
-std::vector<std::string> find_week_files(const std::string &pmatch = "week-")
+/**
+ * task directories (roots): path list of $POMODORO_DIRS separated by ':' (like $PATH),
+ * or the single $POMODORO_DIR. index of the root is the root ID of its tasks.
+ * find_task_roots: empty if neither is set, task_roots: exits with the error (the app)
+ */
+std::vector<std::string> find_task_roots()
 {
-    std::string POMODORO_DIR = str::sane_getenv("POMODORO_DIR");
-    std::vector<std::string> fpaths = get_all_files_recursive(POMODORO_DIR);
+    const char *dirs = std::getenv("POMODORO_DIRS");
+    std::vector<std::string> roots;
+    std::string root;
+    std::istringstream dirs_stream(dirs ? dirs : "");
+    while (std::getline(dirs_stream, root, ':')) {
+        if (!root.empty())
+            roots.push_back(root);
+    }
+    if (roots.empty()) {
+        const char *dir = std::getenv("POMODORO_DIR");
+        root = (dir) ? dir : "";
+        root = root.substr(0, root.find(' ')); // sanitized like str::sane_getenv
+        if (!root.empty())
+            roots.push_back(root);
+    }
+    return roots;
+}
+
+std::vector<std::string> task_roots()
+{
+    std::vector<std::string> roots = find_task_roots();
+    if (roots.empty())
+        roots.push_back(str::sane_getenv("POMODORO_DIR")); // NOTE: exits with the error
+    return roots;
+}
+
+std::vector<std::string> find_week_files(const std::string &root, const std::string &pmatch)
+{
+    if (!fs::is_directory(root)) {
+        std::cerr << "[Warning]: task directory not found: '" << root << "'\n";
+        return {};
+    }
+    std::vector<std::string> fpaths = get_all_files_recursive(root);
     std::vector<std::string>& v = fpaths; // reference for shortness
     auto match = [=](const std::string &tmps) {
         return tmps.find(pmatch) == std::string::npos;
     }; // remove all paths which does not include pattern match
     v.erase(std::remove_if(v.begin(), v.end(), match), v.end());
+    // compressed (archived) week files: week-05-2021.txt.gz, week-05-2021.txt.zst
+    // skip unknown compressed files & archived copies of the week files which are also present as plain text
+    std::set<std::string> plain(v.begin(), v.end());
+    auto archived = [&](const std::string &tmps) {
+        if (!str::is_compressed(tmps))
+            return false;
+        const std::string stem = tmps.substr(0, tmps.rfind('.'));
+        return !str::ends_with(stem, ".txt") || plain.count(stem) != 0;
+    };
+    v.erase(std::remove_if(v.begin(), v.end(), archived), v.end());
     if (v.empty())
         return {};
+    // in the order of the weeks (week-52-2021 < week-01-2022), not week files -> at the end
+    auto order = [](const std::string &p) {
+        const int key = cal::file_weeks(p).key;
+        return (key) ? key : std::numeric_limits<int>::max();
+    };
+    std::stable_sort(v.begin(), v.end(), [&](const std::string &a, const std::string &b) {
+        return order(a) < order(b);
+    });
 #if 0
     for (const auto &p : fpaths) {
         std::cout << p <<  std::endl;
@@ -245,29 +334,28 @@ std::vector<std::string> find_week_files(const std::string &pmatch = "week-")
 }
 
 /**
- * construct & return week file name by the date string
+ * day of the date string, "now", dates in the future & not valid dates -> today
+ */
+static int day_of_date(const std::string &date_str)
+{
+    const int today = cal::days_of(cal::today());
+    cal::date_t d {};
+    if (date_str == "now" || !cal::parse_date(date_str, d) || cal::days_of(d) > today)
+        return today;
+    return cal::days_of(d);
+}
+
+static cal::isoweek_t week_of_date(const std::string &date_str)
+{
+    return cal::isoweek_of(day_of_date(date_str));
+}
+
+/**
+ * construct & return week file name by the date string (week-%V-%Y.txt: ISO week & calendar year)
  */
 std::string week_file_name(const std::string &date_str)
 {
-    std::tm tm1 {}, tm2 {};
-    const char* wfmt = "week-%V-%Y.txt";
-    const std::time_t now = std::time(nullptr);
-    tm1 = *std::localtime(&now);
-    std::ostringstream buf;
-    if (date_str == "now") {
-        buf << std::put_time(&tm1, wfmt);
-        return buf.str();
-    }
-    std::istringstream ss(date_str);
-    ss.imbue(std::locale("en_US.utf-8"));
-    ss >> std::get_time(&tm2, str::datef);
-    const std::time_t t = std::mktime(&tm2);
-    // if date str > date now => current week fname
-    if (std::difftime(now, t) < 0)
-        buf << std::put_time(&tm1, wfmt);
-    else
-        buf << std::put_time(&tm2, wfmt);
-    return buf.str();
+    return cal::file_name(cal::date_of(day_of_date(date_str)));
 }
 
 /**
@@ -297,86 +385,61 @@ int item_index(const std::vector<std::string> &v, const std::string &item)
     return -1; // return the last element index
 }
 
-std::string find_week_file_by_date(const std::string &date_str)
-{
-    const std::vector<std::string> found = find_week_files(week_file_name(date_str));
-    if (found.empty()) { // find closest next found week file
-        const std::vector<std::string> fpaths = find_week_files();
-        const std::string fake_fname = week_file_name(date_str);
-        std::vector<std::string> fnames;
-        fnames.push_back(fake_fname); // add fake entry week fname
-        for (const fs::path p : fpaths)
-            fnames.push_back(p.filename());
-        // fname example: week-05-2022.txt
-        // substr(8, 4) = year; substr(5, 2) = week_num
-        std::sort(fnames.begin(), fnames.end(),
-            [](const std::string &a, const std::string &b) -> bool
-        {
-            return
-            (
-                (a.substr(8, 4) < b.substr(8, 4)) ||
-                (a.substr(8, 4) == b.substr(8, 4) && a.substr(5, 2) < b.substr(5, 2))
-            );
-        });
-#if 0
-        fmt::print("{}\n", fmt::join(fnames, "\n"));
-        std::cout << "fake_fname: " << fake_fname << '\n';
-#endif
-        // find index of the fake entry & return next week file
-        int index = item_index(fnames, fake_fname);
-        return fpaths[index];
+/**
+ * week file of the week of the date, or the closest next one, or the last one
+ */
+std::string find_week_file_by_date(const std::string &root, const std::string &date_str)
+{
+    const int key = cal::week_key(week_of_date(date_str));
+    std::string last;
+    for (const auto &p : find_week_files(root)) {
+        const cal::file_weeks_t k = cal::file_weeks(p);
+        if (!k.key)
+            continue;
+        if (k.key >= key || k.has(key))
+            return p;
+        last = p;
     }
-    return found[0];
+    return last;
 }
 
-std::string find_last_week_file()
+std::string find_last_week_file(const std::string &root)
 {
-    return find_week_file_by_date("now");
+    return find_week_file_by_date(root, "now");
 }
 
-std::vector<std::string> find_week_files_in_span(const std::string &fr, const std::string &to)
+/**
+ * week files of the weeks from the week of `fr` to the week of `to` (including) in the order of the weeks,
+ * a week file named by the calendar year around new year is selected by any of its 2 weeks
+ */
+std::vector<std::string> find_week_files_in_span(const std::string &root,
+                                                 const std::string &fr, const std::string &to)
 {
-    const std::string fr_fpath = find_week_file_by_date(fr);
-    const std::string to_fpath = find_week_file_by_date(to);
-    const std::vector<std::string> fpaths = find_week_files();
-    int fr_index = item_index(fpaths, fr_fpath);
-    int to_index = item_index(fpaths, to_fpath);
-    std::vector<std::string> fpaths_span = vslice(fpaths, fr_index, to_index + 1); // +1 including
-#if 0
-    for (const auto &p : fpaths_span) {
-        std::cout << p << std::endl;
+    const int fr_key = cal::week_key(week_of_date(fr));
+    const int to_key = cal::week_key(week_of_date(to));
+    std::vector<std::string> fpaths_span;
+    for (auto &p : find_week_files(root)) {
+        if (cal::file_weeks(p).in(fr_key, to_key))
+            fpaths_span.push_back(std::move(p));
     }
-    std::cout << '\n';
-    std::cout << fr_index << "\tfr fpath: " << fr_fpath << std::endl;
-    std::cout << to_index << "\tto fpath: " << to_fpath << std::endl;
-#endif
     return fpaths_span;
 }
 
 /**
- * vector of all dates of the week found by date string
- * (from first to the last day of the week)
+ * vector of all dates of the ISO week of the date string
+ * (from monday to sunday), empty if the date is not valid
  */
 std::vector<std::string> dates_of_week(const std::string &date_str)
 {
-    std::tm tm = {};
-    std::istringstream ss(date_str);
-    ss.imbue(std::locale("en_US.utf-8"));
-    ss >> std::get_time(&tm, str::datef);
-    std::mktime(&tm); // essential in order to set proper tm_wday
-    int first_wday = tm.tm_mday - tm.tm_wday; // first day of the week
-    tm.tm_mday = first_wday;
+    cal::date_t d {};
+    if (!cal::parse_date(date_str, d))
+        return {};
+    const int days = cal::days_of(d);
+    const int monday = days - (cal::weekday(days) - 1);
     std::vector<std::string> wdates;
-    std::ostringstream buf;
-    for (int i = 0; i < 7; i++) {
-        // FIXME: HACK: to make sunday last day of the week, not first.
-        if (i == 0 && tm.tm_wday == 0) tm.tm_mday -= 7;
-        tm.tm_mday += 1;
-        std::mktime(&tm);
-        buf.clear(); buf.str(""); // clean buffer before inserting new date
-        buf << std::put_time(&tm, str::datef);
-        wdates.push_back(buf.str());
-    }
+    wdates.reserve(7);
+    for (int i = 0; i < 7; i++)
+        wdates.push_back(cal::date_str(cal::date_of(monday + i)));
     return wdates;
 }
 
@@ -420,51 +483,320 @@ bool remove_lines_after_date(std::string &s, const std::string &date_str)
     return false;
 }
 
+/**
+ * read week files of the span concurrently & hand each file to the consumer as soon as it arrives,
+ * lines before & after the range of dates are already removed from the first & last file.
+ * consumer is called on the calling thread:
+ * consume(index of the file in fpaths, content, number of the lines removed from the beginning of the file,
+ *         bytes read from the file)
+ */
+template<typename Func>
+static void consume_week_files(const std::vector<std::string> &fpaths,
+                               const std::string &fr, const std::string &to, Func consume)
+{
+    io::chan_t<io::fchunk_t> ch { io::io_workers(fpaths.size()) * 2 };
+    std::future<void> reading = io::read_files_async(fpaths, ch);
+    const std::size_t last = fpaths.size() - 1;
+    auto count_lines = [](const std::string &c) {
+        return static_cast<std::size_t>(std::count(c.begin(), c.end(), '\n'));
+    };
+    while (std::optional<io::fchunk_t> fc = ch.pop()) {
+        std::string &content = fc->content;
+        const std::size_t read_size = content.size();
+        std::size_t first_line {0};
+        if (fc->index == 0) {
+            const std::size_t nlines = count_lines(content);
+            remove_lines_before_date(content, fr);
+            first_line = nlines - count_lines(content);
+        }
+        if (fc->index == last)
+            remove_lines_after_date(content, to);
+        // do not glue the last line of the file with the first line of the next file
+        if (!content.empty() && content.back() != '\n')
+            content.push_back('\n');
+        consume(fc->index, std::move(content), first_line, read_size);
+    }
+    reading.get();
+}
+
+static std::string join_contents(const std::vector<std::string> &contents)
+{
+    std::size_t size {0};
+    for (const auto &c : contents)
+        size += c.size();
+    std::string buf;
+    buf.reserve(size);
+    for (const auto &c : contents)
+        buf += c;
+    return buf;
+}
+
+/**
+ * contents of the roots one after another (separated by the line break)
+ */
+static std::string join_root_contents(const std::vector<std::string> &contents)
+{
+    std::string buf;
+    for (const auto &c : contents) {
+        if (c.empty())
+            continue;
+        if (!buf.empty())
+            buf += '\n';
+        buf += c;
+    }
+    return buf;
+}
+
 /**
  * concatenate week files removing lines before & after range of dates
  */
 const std::string concat_week_files(std::vector<std::string> &fpaths,
                                     const std::string &fr, const std::string &to)
 {
-    // if the date range matches one file
-    if (fpaths.size() == 1) {
-        std::string fcontent = str::file_content(fpaths[0]);
-        remove_lines_before_date(fcontent, fr);
-        remove_lines_after_date(fcontent, to);
-        return str::trim(fcontent);
-    }
-    std::string fcontent_first = str::file_content(fpaths[0]);
-    std::string fcontent_last  = str::file_content(fpaths.back());
-    remove_lines_before_date(fcontent_first, fr);
-    remove_lines_after_date(fcontent_last, to);
-    std::ostringstream buf;
-    buf << fcontent_first;
-    for (int i = 1; i < fpaths.size() - 1; i++)
-        buf << str::file_content(fpaths[i]);
-    buf << fcontent_last;
-    return str::trim(buf.str());
+    if (fpaths.empty())
+        return {};
+    std::vector<std::string> contents(fpaths.size());
+    consume_week_files(fpaths, fr, to, [&](std::size_t i, std::string &&content, std::size_t, std::size_t) {
+        contents[i] = std::move(content);
+    });
+    return str::trim(join_contents(contents));
 }
 
 std::string concat_span(const std::string &fr, const std::string &to)
 {
-    std::vector<std::string> fpaths = find_week_files_in_span(fr, to);
-    std::string content = concat_week_files(fpaths, fr, to);
-    return content;
+    const mem::scope_t mscope(mem::stage_t::LOAD);
+    std::vector<std::string> contents;
+    for (const auto &root : task_roots()) {
+        std::vector<std::string> fpaths = find_week_files_in_span(root, fr, to);
+        contents.push_back(concat_week_files(fpaths, fr, to));
+    }
+    return join_root_contents(contents);
+}
+
+/**
+ * k-way merge of the per-root task streams into one timeline ordered by the beginning of the tasks
+ * (tasks with the same beginning keep the order of the roots)
+ */
+ss::vtasks_t merge_timelines(std::vector<ss::vtasks_t> &&streams)
+{
+    if (streams.size() == 1)
+        return std::move(streams[0]);
+    using head_t = std::pair<std::time_t, std::size_t>; // beginning of the head task & stream index
+    std::priority_queue<head_t, std::vector<head_t>, std::greater<head_t>> heap;
+    std::vector<std::size_t> pos(streams.size(), 0);
+    std::size_t total {0};
+    for (std::size_t i = 0; i < streams.size(); i++) {
+        total += streams[i].size();
+        if (!streams[i].empty())
+            heap.push({ streams[i][0].hm_t.beg, i });
+    }
+    ss::vtasks_t vtt;
+    vtt.reserve(total);
+    while (!heap.empty()) {
+        const std::size_t i = heap.top().second;
+        heap.pop();
+        vtt.push_back(std::move(streams[i][pos[i]++]));
+        if (pos[i] < streams[i].size())
+            heap.push({ streams[i][pos[i]].hm_t.beg, i });
+    }
+    return vtt;
 }
 
 /**
- * filter multiline string by lines containing matching pattern
+ * concatenate week files of the span of one root & parse them in the same pass:
+ * parsing of each file starts as soon as it was read (overlaps with reading of the rest).
+ * tasks of each parsed file are reported as soon as they are ready (see load_span()).
+ * lines which are not tasks are logged with the file index from file_base (index of the first file).
  */
+static ss::span_t load_root_span(const std::vector<std::string> &fpaths, std::uint16_t root_id,
+                                 std::uint32_t file_base, const std::string &fr, const std::string &to,
+                                 const std::function<void(const ss::vtasks_t &)> &parsed)
+{
+    const mem::scope_t mscope(mem::stage_t::LOAD);
+    if (fpaths.empty())
+        return {};
+    const bool single = fpaths.size() == 1; // nothing to overlap with -> parse the file in parallel
+    std::vector<std::string> contents(fpaths.size()); // NOTE: preallocated -> stable references
+    std::vector<diag::log_t> logs(fpaths.size()); // of the parsing threads, one per file
+    std::vector<exec::future_t<ss::vtasks_t>> futures(fpaths.size());
+    ss::span_t span {};
+    span.fsizes.resize(fpaths.size());
+    consume_week_files(fpaths, fr, to, [&](std::size_t i, std::string &&content, std::size_t first_line,
+                                           std::size_t read_size) {
+        contents[i] = std::move(content);
+        span.fsizes[i] = read_size;
+        logs[i] = diag::log_t(file_base + static_cast<std::uint32_t>(i), first_line);
+        futures[i] = exec::async([&c = contents[i], &log = logs[i], &parsed, single, root_id]() {
+            ss::vtasks_t vtt = (single) ? parse_tasks_parallel(c, &log) : parse_tasks(c, &log);
+            for (auto &t : vtt)
+                t.root = root_id;
+            parsed(vtt);
+            return vtt;
+        });
+    });
+    for (std::size_t i = 0; i < futures.size(); i++) {
+        ss::vtasks_t tmp_vec = futures[i].get();
+        span.vtt.insert(span.vtt.end(), tmp_vec.begin(), tmp_vec.end());
+        span.diag.merge(logs[i]);
+    }
+    span.content = str::trim(join_contents(contents));
+    return span;
+}
+
+/**
+ * load & parse the span of the roots, each root is scanned in parallel,
+ * tasks of the roots are merged into one timeline.
+ * progress (if any) gets tasks of every parsed week file as soon as they are ready
+ * (in any order, called concurrently from the parsing threads).
+ */
+ss::span_t load_span(const std::vector<std::string> &roots,
+                     const std::string &fr, const std::string &to, const progress_fn_t &progress)
+{
+    const mem::scope_t mscope(mem::stage_t::LOAD);
+    std::vector<std::vector<std::string>> fpaths;
+    std::size_t total {0};
+    for (const auto &root : roots) {
+        fpaths.push_back(find_week_files_in_span(root, fr, to));
+        total += fpaths.back().size();
+    }
+    std::atomic<std::size_t> done {0};
+    const std::function<void(const ss::vtasks_t &)> parsed = [&](const ss::vtasks_t &vtt) {
+        const std::size_t n = ++done;
+        if (progress)
+            progress(n, total, vtt);
+    };
+    std::vector<exec::future_t<ss::span_t>> futures;
+    std::uint32_t file_base {0};
+    for (std::size_t i = 0; i < roots.size(); i++) {
+        futures.push_back(exec::async(load_root_span, std::cref(fpaths[i]),
+                                     static_cast<std::uint16_t>(i), file_base, std::cref(fr), std::cref(to),
+                                     std::cref(parsed)));
+        file_base += static_cast<std::uint32_t>(fpaths[i].size());
+    }
+    ss::span_t span {};
+    std::vector<std::string>  contents;
+    std::vector<ss::vtasks_t> streams;
+    for (auto &f : futures) {
+        ss::span_t root_span = f.get();
+        contents.push_back(std::move(root_span.content));
+        streams.push_back(std::move(root_span.vtt));
+        span.diag.merge(root_span.diag);
+        span.fsizes.insert(span.fsizes.end(), root_span.fsizes.begin(), root_span.fsizes.end());
+    }
+    for (auto &root_fpaths : fpaths)
+        span.fpaths.insert(span.fpaths.end(), root_fpaths.begin(), root_fpaths.end());
+    span.content = join_root_contents(contents);
+    // line-offset table is built while the timelines are merged
+    exec::future_t<lines::index_t> idx = exec::async(lines::build_index, std::string_view(span.content));
+    span.vtt = merge_timelines(std::move(streams));
+    span.idx = idx.get();
+    return span;
+}
+
+ss::span_t load_span(const std::string &fr, const std::string &to, const progress_fn_t &progress)
+{
+    return load_span(task_roots(), fr, to, progress);
+}
+
+/**
+ * tail of the week file continuing at the byte where load_span stopped reading it
+ * -> lines appended since then are read by the tail (at its end if the file is not in the span)
+ */
+tail::state_t tail_after_span(const std::vector<std::string> &fpaths, const std::vector<std::uintmax_t> &fsizes,
+                              const std::string &fpath)
+{
+    const auto it = std::find(fpaths.begin(), fpaths.end(), fpath);
+    const std::size_t i = static_cast<std::size_t>(it - fpaths.begin());
+    if (it == fpaths.end() || i >= fsizes.size())
+        return tail::init(fpath);
+    return tail::init(fpath, fsizes[i]);
+}
+
+/**
+ * cancellation token is checked once per 4096 lines/tasks
+ */
+static inline bool canceled(const std::atomic<bool> *cancel, std::size_t i)
+{
+    return cancel && (i & 0xfff) == 0 && cancel->load(std::memory_order_relaxed);
+}
+
+/**
+ * error of the filter pattern, empty if it is valid: checked by the engine which matches it
+ * (the DFA matcher or ECMAScript std::regex), NOTE: std::regex may still throw while matching (complexity)
+ */
+std::string filter_error(const std::string &reinput)
+{
+    if (dfa::matcher_t(reinput, true).supported())
+        return {};
+    try {
+        const std::regex re(reinput, std::regex::ECMAScript|std::regex::icase);
+    } catch (const std::regex_error &e) {
+        return e.what();
+    }
+    return {};
+}
+
+/**
+ * filter multiline string by lines containing matching pattern.
+ * pattern is matched by the linear time DFA matcher (bounded by the input size),
+ * std::regex is used only for the features which the DFA matcher does not support.
+ */
+std::string filter_find(std::string_view s, const lines::index_t &idx, const std::string &reinput,
+                        const std::atomic<bool> *cancel)
+{
+    const mem::scope_t mscope(mem::stage_t::FILTER);
+    std::string out;
+    auto filter = [&](auto &&match) {
+        for (std::size_t nl = 0; nl < idx.count(); nl++) {
+            if (canceled(cancel, nl))
+                return; // superseded -> the caller discards partial result
+            const std::string_view line = idx.line(s, nl);
+            if (match(line)) {
+                out += line;
+                out += '\n';
+            }
+        }
+    };
+    dfa::matcher_t dm(reinput, true);
+    if (dm.supported()) {
+        filter([&](std::string_view line) { return dm.search(line); });
+    } else {
+        const std::regex re(reinput, std::regex::ECMAScript|std::regex::icase);
+        filter([&](std::string_view line) { return std::regex_search(line.begin(), line.end(), re); });
+    }
+    return out;
+}
+
 std::string filter_find(const std::string &s, const std::string &reinput)
 {
-    const std::regex re(reinput, std::regex::ECMAScript|std::regex::icase);
-    std::smatch m;
+    return filter_find(s, lines::build_index(s), reinput);
+}
+
+/**
+ * tasks which source lines match the pattern (same lines as kept by filter_find())
+ */
+ss::vtasks_t filter_tasks(const ss::vtasks_t &vtt, const std::string &reinput,
+                          const std::atomic<bool> *cancel)
+{
+    const mem::scope_t mscope(mem::stage_t::FILTER);
+    ss::vtasks_t out;
     std::string line;
-    std::istringstream iss(s);
-    std::ostringstream oss;
-    while (std::getline(iss, line)) {
-        if(std::regex_search(line, m, re))
-            oss << line << '\n';
+    auto filter = [&](auto &&match) {
+        for (std::size_t i = 0; i < vtt.size(); i++) {
+            if (canceled(cancel, i))
+                return; // superseded -> the caller discards partial result
+            const ss::task_t &t = vtt[i];
+            line = t.dts + ' ' + t.text; // NOTE: same as the source line of the task
+            if (match(line))
+                out.push_back(t);
+        }
+    };
+    dfa::matcher_t dm(reinput, true);
+    if (dm.supported()) {
+        filter([&](std::string_view line) { return dm.search(line); });
+    } else {
+        const std::regex re(reinput, std::regex::ECMAScript|std::regex::icase);
+        filter([&](std::string_view line) { return std::regex_search(line.begin(), line.end(), re); });
     }
-    return oss.str();
+    return out;
 }
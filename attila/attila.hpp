@@ -1,12 +1,19 @@
 #ifndef ATTILA_HPP
 #define ATTILA_HPP
 
+#include <atomic>
 #include <filesystem>
+#include <functional>
+#include <optional>
 #include <regex>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "structs.hpp" // ss namespace with struct defs
+#include "diag.hpp"    // parse diagnostics
+#include "lines.hpp"   // line-offset table
+#include "tail.hpp"    // reading of the appended lines
 
 std::vector<int> split_vi(const std::string &s, char delimiter);
 int item_index(const std::vector<std::string> &v, const std::string &item);
@@ -16,26 +23,50 @@ const ss::hm_t calculate_time_spent(
         const std::string &d_fr, const std::string &d_to,
         const std::string &t_fr, const std::string &t_to);
 
-const ss::hm_t time_spent(const std::string &s);
-const std::pair<const std::string, const std::string> dts_and_task(const std::string &s);
+std::optional<ss::hm_t> time_spent(const std::string &s);
+std::optional<std::pair<std::string, std::string>> dts_and_task(const std::string &s);
 std::vector<std::string> projects_of_task(const std::string &s);
 
-ss::vtasks_t parse_tasks(const std::string &s);
-ss::vtasks_t parse_tasks_parallel(const std::string &s);
+/**
+ * lines which are not tasks are skipped & reported into the diagnostics log (if any)
+ */
+ss::vtasks_t parse_tasks(std::string_view s, const lines::index_t &idx,
+                         std::size_t beg_nl, std::size_t end_nl, diag::log_t *log = nullptr);
+ss::vtasks_t parse_tasks(const std::string &s, diag::log_t *log = nullptr);
+ss::vtasks_t parse_tasks_parallel(std::string_view s, const lines::index_t &idx, diag::log_t *log = nullptr);
+ss::vtasks_t parse_tasks_parallel(const std::string &s, diag::log_t *log = nullptr);
 
 std::string concat_span(const std::string &fr, const std::string &to);
 const std::string concat_week_files(std::vector<std::string> &fpaths,
                                     const std::string &fr, const std::string &to);
+ss::vtasks_t merge_timelines(std::vector<ss::vtasks_t> &&streams);
+/**
+ * progress of the span loading: done & total week files, tasks of the file parsed just now
+ */
+using progress_fn_t = std::function<void(std::size_t done, std::size_t total, const ss::vtasks_t &vtt)>;
+ss::span_t load_span(const std::vector<std::string> &roots,
+                     const std::string &fr, const std::string &to, const progress_fn_t &progress = {});
+ss::span_t load_span(const std::string &fr, const std::string &to, const progress_fn_t &progress = {}); // task_roots()
+tail::state_t tail_after_span(const std::vector<std::string> &fpaths, const std::vector<std::uintmax_t> &fsizes,
+                              const std::string &fpath); // span_t::fpaths & fsizes
 std::vector<std::string> dates_of_week(const std::string &date_str);
+std::string filter_error(const std::string &reinput); // empty -> valid pattern
+std::string filter_find(std::string_view s, const lines::index_t &idx, const std::string &reinput,
+                        const std::atomic<bool> *cancel = nullptr);
 std::string filter_find(const std::string &s, const std::string &reinput);
+ss::vtasks_t filter_tasks(const ss::vtasks_t &vtt, const std::string &reinput,
+                          const std::atomic<bool> *cancel = nullptr);
 
 std::vector<std::string> get_all_files_recursive(const std::filesystem::path &path);
-std::vector<std::string> find_week_files(const std::string &pmatch);
-std::vector<std::string> find_week_files_in_span(const std::string &fr, const std::string &to);
+std::vector<std::string> find_task_roots(); // empty if not set
+std::vector<std::string> task_roots();      // exits if not set
+std::vector<std::string> find_week_files(const std::string &root, const std::string &pmatch = "week-");
+std::vector<std::string> find_week_files_in_span(const std::string &root,
+                                                 const std::string &fr, const std::string &to);
 
 std::string week_file_name(const std::string &date_str);
-std::string find_week_file_by_date(const std::string &date_str);
-std::string find_last_week_file();
+std::string find_week_file_by_date(const std::string &root, const std::string &date_str);
+std::string find_last_week_file(const std::string &root);
 
 bool remove_lines_after_date (std::string &s, const std::string &date_str);
 bool remove_lines_before_date(std::string &s, const std::string &date_str);
@@ -0,0 +1,308 @@
+#include <cstddef>   // size_t
+#include <cstdint>   // uint64_t
+#include <ctime>     // time_t
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iostream>  // cout, cerr
+#include <limits>
+#include <string>
+#include <string_view>
+#include <utility>   // pair, swap
+
+#include <fmt/core.h>
+
+#include "batch.hpp"
+#include "attila.hpp"
+#include "cal.hpp"     // ISO week calendar
+#include "diag.hpp"    // parse diagnostics
+#include "exec.hpp"    // shared thread pool
+#include "exporter.hpp" // exporter namespace
+#include "interval.hpp" // overlaps, idle gaps & utilization
+#include "mem.hpp"     // heap accounting per stage
+#include "perf.hpp"    // perf namespace
+#include "query.hpp"   // query namespace
+#include "server.hpp"  // query daemon
+#include "stats.hpp"
+#include "str.hpp"     // str namespace
+#include "structs.hpp" // ss namespace with struct defs
+#include "topk.hpp"    // topk namespace
+
+namespace
+{
+    constexpr const char *usage {
+        "usage: attila --batch [options]\n"
+        "  --from DATE   first date of the span (YYYY-MM-DD), default: monday of the current week\n"
+        "  --to   DATE   last date of the span, default: today\n"
+        "  --query Q     structured filter, e.g. 'project:nvim duration>30m weekday:mon-fri'\n"
+        "  --top  K      size of the top-K tables, default: 10\n"
+        "  --intervals   double-booked tasks, idle gaps & utilization per day at the end of the report\n"
+        "  --idle MIN    shortest reported idle gap in minutes, default: 30\n"
+        "  --export FMT  write rows instead of the report: csv, ndjson, col (columnar binary)\n"
+        "  --rows ROWS   exported rows: tasks (default), merged, near (merged near-duplicates), projects, texts\n"
+        "  --out  FILE   export destination, default: stdout\n"
+        "  --mem         heap usage per pipeline stage to stderr at the end\n"
+        "  --perf CORPUS performance regression run on a synthetic corpus: small, medium, large\n"
+        "  --baselines FILE  baselines of the --perf run, default: perf_baselines.txt\n"
+        "  --corpus DIR  directory of the generated corpus, default: temporary directory\n"
+        "  --update      store the --perf measurements as the new baselines\n"
+        "  --threads N   worker threads, default: ATTILA_THREADS or the number of cores\n"
+        "  --cpus LIST   pin the workers to the CPUs, e.g. 0-3,6 (Linux), default: ATTILA_CPUS\n"
+        "  --serve SOCKET    keep the parsed archive in memory & answer the queries on the Unix socket\n"
+        "  --connect SOCKET  ask the daemon instead of loading the span (--from, --to, --query, --ask)\n"
+        "  --ask WHAT    answer of the daemon: tasks (default), stats, merged, status\n"
+    };
+
+    // monday of the current week & today (same default span as the UI)
+    std::pair<std::string, std::string> current_week()
+    {
+        const int today = cal::days_of(cal::today());
+        const int monday = today - (cal::weekday(today) - 1);
+        return { cal::date_str(cal::date_of(monday)), cal::date_str(cal::date_of(today)) };
+    }
+
+    int export_rows(const ss::span_t &span, const ss::vtasks_t &vtt, exporter::format_t f,
+                    const std::string &rows, const std::string &out)
+    {
+        std::ofstream ofile;
+        if (!out.empty()) {
+            ofile.open(out, std::ios::binary);
+            if (!ofile) {
+                std::cerr << "[Error]: cannot open the export file: '" << out << "'" << std::endl;
+                return 2;
+            }
+        }
+        std::ostream &os = (out.empty()) ? std::cout : ofile;
+        constexpr std::size_t all { std::numeric_limits<std::size_t>::max() };
+        if (rows == "tasks")
+            exporter::write_tasks(os, vtt, f);
+        else if (rows == "merged")
+            exporter::write_tasks(os, merge_tasks(vtt, span.content).first, f);
+        else if (rows == "near")
+            exporter::write_tasks(os, merge_tasks_near(vtt).first, f);
+        else if (rows == "projects")
+            exporter::write_groups(os, topk::projects(vtt, all), f);
+        else if (rows == "texts")
+            exporter::write_groups(os, topk::texts(vtt, all), f);
+        else {
+            std::cerr << "[Error]: unknown --rows value: '" << rows << "'" << std::endl;
+            return 2;
+        }
+        return (os) ? 0 : 1;
+    }
+
+    /**
+     * thin client of the query daemon: the answer is printed like the spent view / stats line
+     */
+    int remote(const std::string &socket, const std::string &ask, const wire::request_t &base)
+    {
+        wire::request_t rq { base };
+        if (ask == "tasks")
+            rq.op = wire::op_t::TASKS;
+        else if (ask == "stats")
+            rq.op = wire::op_t::STATS;
+        else if (ask == "merged")
+            rq.op = wire::op_t::MERGED;
+        else if (ask == "status")
+            rq.op = wire::op_t::STATUS;
+        else {
+            std::cerr << "[Error]: unknown --ask value: '" << ask << "'" << std::endl;
+            return 2;
+        }
+        std::string body, err;
+        if (!server::ask(socket, rq, body, err)) {
+            std::cerr << "[Error]: " << err << std::endl;
+            return 1;
+        }
+        wire::reader_t r(body);
+        if (static_cast<wire::status_t>(r.u8()) != wire::status_t::OK) {
+            std::cerr << "[Error]: " << r.str() << std::endl;
+            return 2;
+        }
+        switch (rq.op) {
+        case wire::op_t::STATUS: {
+            const std::uint64_t generation = r.u64(), files = r.u64(), tasks = r.u64(), skipped = r.u64();
+            std::cout << fmt::format("generation: {}, week files: {}, tasks: {}, lines skipped: {}\n",
+                                     generation, files, tasks, skipped);
+            break;
+        }
+        case wire::op_t::STATS: {
+            const std::uint64_t sum = r.u64(), avg = r.u64(), max = r.u64(), min = r.u64(), n = r.u64();
+            const ss::stats_human_t sh = calculate_stats_human({ avg, max, min, sum, n });
+            std::cout << fmt::format("tasks: {}, sum: {}, avg: {}, max: {}, min: {}\n",
+                                     n, sh.sum, sh.avg, sh.max, sh.min);
+            break;
+        }
+        case wire::op_t::TASKS:
+        case wire::op_t::MERGED: {
+            const std::uint32_t n = r.u32();
+            if (n > body.size()) // NOTE: at least one byte per task
+                break;
+            ss::vtasks_t vtt(n);
+            for (auto &t : vtt) {
+                t.hm_t.beg  = static_cast<std::time_t>(r.i64());
+                t.hm_t.diff = static_cast<std::time_t>(r.i64());
+                t.root = r.u16();
+                r.u32(); // subtasks
+                t.dts  = r.str();
+                t.text = r.str();
+            }
+            std::cout << str::tasks_to_mulstr(vtt);
+            break;
+        }
+        }
+        if (!r.ok() || !r.done()) {
+            std::cerr << "[Error]: not valid answer of the daemon" << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+
+    /**
+     * dump heap usage per stage at the end of the batch run (--mem),
+     * everything is freed by then -> current bytes of the stages are leftovers
+     */
+    struct mem_dump_t {
+        bool on { false };
+        ~mem_dump_t() {
+            if (on)
+                std::cerr << "\nheap usage per stage:\n" << mem::report(mem::snapshot());
+        }
+    };
+}
+
+int batch::run(int argc, char *argv[])
+{
+    mem_dump_t mem_dump;
+    auto [fr, to] = current_week();
+    std::string q;
+    std::size_t k { 10 };
+    bool intervals { false };
+    std::time_t idle_min { 30 };
+    std::string xfmt, rows { "tasks" }, out;
+    std::string perf_corpus, perf_baselines { "perf_baselines.txt" }, perf_dir;
+    bool perf_update { false };
+    std::string serve_socket, connect_socket, ask { "tasks" };
+    exec::config_t pool = exec::config_from_env();
+    for (int i = 1; i < argc; i++) {
+        const std::string_view arg { argv[i] };
+        const bool has_value = i + 1 < argc;
+        if (arg == "--help" || arg == "-h") {
+            std::cout << usage;
+            return 0;
+        } else if (arg == "--from" && has_value) {
+            fr = argv[++i];
+        } else if (arg == "--to" && has_value) {
+            to = argv[++i];
+        } else if (arg == "--query" && has_value) {
+            q = argv[++i];
+        } else if (arg == "--export" && has_value) {
+            xfmt = argv[++i];
+        } else if (arg == "--rows" && has_value) {
+            rows = argv[++i];
+        } else if (arg == "--out" && has_value) {
+            out = argv[++i];
+        } else if (arg == "--intervals") {
+            intervals = true;
+        } else if (arg == "--idle" && has_value) {
+            try {
+                idle_min = std::stol(argv[++i]);
+            } catch (const std::exception &) {
+                std::cerr << "[Error]: not valid --idle value: '" << argv[i] << "'" << std::endl;
+                return 2;
+            }
+        } else if (arg == "--mem") {
+            mem_dump.on = true;
+        } else if (arg == "--perf" && has_value) {
+            perf_corpus = argv[++i];
+        } else if (arg == "--baselines" && has_value) {
+            perf_baselines = argv[++i];
+        } else if (arg == "--corpus" && has_value) {
+            perf_dir = argv[++i];
+        } else if (arg == "--update") {
+            perf_update = true;
+        } else if (arg == "--serve" && has_value) {
+            serve_socket = argv[++i];
+        } else if (arg == "--connect" && has_value) {
+            connect_socket = argv[++i];
+        } else if (arg == "--ask" && has_value) {
+            ask = argv[++i];
+        } else if (arg == "--threads" && has_value) {
+            try {
+                pool.threads = std::stoul(argv[++i]);
+            } catch (const std::exception &) {
+                std::cerr << "[Error]: not valid --threads value: '" << argv[i] << "'" << std::endl;
+                return 2;
+            }
+        } else if (arg == "--cpus" && has_value) {
+            if (!exec::parse_cpus(argv[++i], pool.cpus)) {
+                std::cerr << "[Error]: not valid --cpus value: '" << argv[i] << "'" << std::endl;
+                return 2;
+            }
+        } else if (arg == "--top" && has_value) {
+            try {
+                k = std::stoul(argv[++i]);
+            } catch (const std::exception &) {
+                std::cerr << "[Error]: not valid --top value: '" << argv[i] << "'" << std::endl;
+                return 2;
+            }
+        } else {
+            std::cerr << "[Error]: unknown option: '" << arg << "'\n" << usage;
+            return 2;
+        }
+    }
+    exec::configure(pool); // NOTE: before the first job
+    if (!serve_socket.empty())
+        return server::run({ serve_socket });
+    if (!connect_socket.empty())
+        return remote(connect_socket, ask, { wire::op_t::TASKS, fr, to, q });
+    if (!perf_corpus.empty()) {
+        if (perf_dir.empty())
+            perf_dir = std::filesystem::temp_directory_path().string();
+        return perf::run(perf_corpus, perf_baselines, perf_dir, perf_update);
+    }
+    if (to < fr)
+        std::swap(fr, to);
+    exporter::format_t f {};
+    if (!xfmt.empty() && !exporter::format_of(xfmt, f)) {
+        std::cerr << "[Error]: unknown export format: '" << xfmt << "'" << std::endl;
+        return 2;
+    }
+
+    const ss::span_t span = load_span(fr, to);
+    ss::vtasks_t vtt;
+    if (q.empty()) {
+        vtt = span.vtt;
+    } else {
+        query::filter_t qf(q);
+        if (!qf.ok()) {
+            std::cerr << "[Error]: not valid query: " << qf.error() << std::endl;
+            return 2;
+        }
+        vtt = qf.filter(span.vtt);
+    }
+
+    if (!xfmt.empty()) {
+        if (span.diag.total()) // NOTE: stdout may be the exported rows
+            std::cerr << diag::report(span.diag, span.fpaths);
+        return export_rows(span, vtt, f, rows, out);
+    }
+
+    std::cout << fmt::format("span: {} -> {}, tasks: {}\n", fr, to, vtt.size());
+    if (span.diag.total())
+        std::cout << diag::summary(span.diag) << " -> see the end of the report\n";
+    if (vtt.empty()) {
+        if (span.diag.total())
+            std::cout << '\n' << diag::report(span.diag, span.fpaths);
+        return 1;
+    }
+    const mem::scope_t mscope(mem::stage_t::ANALYZE);
+    const ss::stats_human_t sh = calculate_stats_human(calculate_stats(vtt));
+    std::cout << fmt::format("sum: {}, avg: {}, max: {}, min: {}\n\n", sh.sum, sh.avg, sh.max, sh.min);
+    std::cout << topk::report(vtt, k);
+    if (intervals)
+        std::cout << '\n' << interval::report(interval::index_t(vtt), vtt, idle_min * 60);
+    if (span.diag.total())
+        std::cout << '\n' << diag::report(span.diag, span.fpaths);
+    return 0;
+}
@@ -0,0 +1,13 @@
+#ifndef BATCH_HPP
+#define BATCH_HPP
+
+namespace batch
+{
+    /**
+     * non-interactive mode: attila --batch [options] -> report of the date span to stdout
+     * (no window, no Qt event loop). returns process exit code.
+     */
+    int run(int argc, char *argv[]);
+}
+
+#endif // BATCH_HPP
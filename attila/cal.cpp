@@ -0,0 +1,39 @@
+#include <ctime> // time, localtime_r
+
+#include <fmt/core.h>
+
+#include "cal.hpp"
+
+// the year boundaries: week 53 of the previous year & week 1 starting in december
+static_assert(cal::days_of(cal::date_t { 1970, 1, 1 }) == 0);
+static_assert(cal::date_of(cal::days_of(cal::date_t { 2024, 2, 29 })) == cal::date_t { 2024, 2, 29 });
+static_assert(cal::isoweek_of(cal::days_of(cal::date_t { 2021, 1, 3 })) == cal::isoweek_t { 2020, 53, 7 });
+static_assert(cal::isoweek_of(cal::days_of(cal::date_t { 2021, 1, 4 })) == cal::isoweek_t { 2021, 1, 1 });
+static_assert(cal::isoweek_of(cal::days_of(cal::date_t { 2022, 1, 1 })) == cal::isoweek_t { 2021, 52, 6 });
+static_assert(cal::isoweek_of(cal::days_of(cal::date_t { 2024, 12, 30 })) == cal::isoweek_t { 2025, 1, 1 });
+static_assert(cal::weeks_in_year(2020) == 53 && cal::weeks_in_year(2021) == 52);
+static_assert(cal::file_weeks("tasks/week-05-2021.txt.gz").key == 202105 && !cal::file_weeks("week-54-2021.txt").key);
+// old-style names (calendar year): 2021-01-03 is in week-53-2021.txt, 2024-12-30 in week-01-2024.txt
+static_assert(cal::file_weeks("week-53-2021.txt").key == 202053 && !cal::file_weeks("week-53-2021.txt").alt);
+static_assert(cal::file_weeks("week-01-2024.txt").key == 202401 && cal::file_weeks("week-01-2024.txt").alt == 202501);
+static_assert(cal::file_weeks("week-52-2022.txt").key == 202252 && cal::file_weeks("week-52-2022.txt").alt == 202152);
+// names by the ISO year resolve to the same weeks
+static_assert(cal::file_weeks("week-53-2020.txt").has(202053) && cal::file_weeks("week-01-2025.txt").has(202501));
+
+cal::date_t cal::today()
+{
+    const std::time_t now = std::time(nullptr);
+    std::tm tm {};
+    localtime_r(&now, &tm);
+    return { tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday };
+}
+
+std::string cal::date_str(const cal::date_t &d)
+{
+    return fmt::format("{:04}-{:02}-{:02}", d.year, d.month, d.day);
+}
+
+std::string cal::file_name(const cal::date_t &d)
+{
+    return fmt::format("week-{:02}-{}.txt", cal::isoweek_of(cal::days_of(d)).week, d.year);
+}
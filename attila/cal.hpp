@@ -0,0 +1,204 @@
+#ifndef CAL_HPP
+#define CAL_HPP
+
+#include <string>
+#include <string_view>
+
+namespace cal
+{
+    /**
+     * ISO-8601 week calendar on plain integers (proleptic gregorian, no locale, no time zone):
+     * date <-> days since 1970-01-01 <-> (ISO year, week, weekday), week <-> week file key.
+     * week 1 is the week with the first thursday of the year, weeks start on monday
+     * -> 2021-01-03 is the sunday of week 53 of 2020, 2024-12-30 is the monday of week 1 of 2025.
+     */
+    struct date_t {
+        int year;
+        int month; // 1..12
+        int day;   // 1..31
+    };
+
+    struct isoweek_t {
+        int year;  // ISO week-numbering year (differs from the calendar year around new year)
+        int week;  // 1..53
+        int wday;  // 1 (monday) .. 7 (sunday)
+    };
+
+    constexpr bool operator==(const date_t &a, const date_t &b)
+    {
+        return a.year == b.year && a.month == b.month && a.day == b.day;
+    }
+    constexpr bool operator==(const isoweek_t &a, const isoweek_t &b)
+    {
+        return a.year == b.year && a.week == b.week && a.wday == b.wday;
+    }
+
+    constexpr bool is_leap(int y)
+    {
+        return (y % 4 == 0 && y % 100 != 0) || y % 400 == 0;
+    }
+
+    constexpr int days_in_month(int y, int m)
+    {
+        constexpr int dm[] { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+        return (m == 2 && is_leap(y)) ? 29 : dm[m - 1];
+    }
+
+    constexpr bool valid(const date_t &d)
+    {
+        return d.month >= 1 && d.month <= 12 && d.day >= 1 && d.day <= days_in_month(d.year, d.month);
+    }
+
+    // days since 1970-01-01 (era based algorithm by H. Hinnant)
+    constexpr int days_of(const date_t &d)
+    {
+        const int y = d.year - (d.month <= 2);
+        const int era = (y >= 0 ? y : y - 399) / 400;
+        const int yoe = y - era * 400;
+        const int doy = (153 * (d.month + (d.month > 2 ? -3 : 9)) + 2) / 5 + d.day - 1;
+        const int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+        return era * 146097 + doe - 719468;
+    }
+
+    constexpr date_t date_of(int days)
+    {
+        const int z = days + 719468;
+        const int era = (z >= 0 ? z : z - 146096) / 146097;
+        const int doe = z - era * 146097;
+        const int yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+        const int doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+        const int mp = (5 * doy + 2) / 153;
+        const int d = doy - (153 * mp + 2) / 5 + 1;
+        const int m = mp + (mp < 10 ? 3 : -9);
+        return { yoe + era * 400 + (m <= 2), m, d };
+    }
+
+    // 1 (monday) .. 7 (sunday), 1970-01-01 was thursday
+    constexpr int weekday(int days)
+    {
+        const int r = (days + 3) % 7;
+        return ((r < 0) ? r + 7 : r) + 1;
+    }
+
+    // days of monday of week 1 of the ISO year
+    constexpr int first_monday(int iso_year)
+    {
+        const int jan4 = days_of({ iso_year, 1, 4 }); // always in week 1
+        return jan4 - (weekday(jan4) - 1);
+    }
+
+    constexpr int weeks_in_year(int iso_year)
+    {
+        return (first_monday(iso_year + 1) - first_monday(iso_year)) / 7;
+    }
+
+    constexpr isoweek_t isoweek_of(int days)
+    {
+        const int wday = weekday(days);
+        const int thursday = days - wday + 4; // the year of the thursday is the ISO year of the week
+        const int year = date_of(thursday).year;
+        return { year, (thursday - first_monday(year)) / 7 + 1, wday };
+    }
+
+    constexpr int days_of(const isoweek_t &w)
+    {
+        return first_monday(w.year) + (w.week - 1) * 7 + (w.wday - 1);
+    }
+
+    /**
+     * key of the week: ordered like the weeks (2020-W53 < 2021-W01), week file week-05-2021.txt -> 202105
+     */
+    constexpr int week_key(int iso_year, int week)
+    {
+        return iso_year * 100 + week;
+    }
+    constexpr int week_key(const isoweek_t &w)
+    {
+        return week_key(w.year, w.week);
+    }
+
+    constexpr bool parse_uint(std::string_view s, int &v)
+    {
+        if (s.empty())
+            return false;
+        v = 0;
+        for (const char c : s) {
+            if (c < '0' || c > '9')
+                return false;
+            v = v * 10 + (c - '0');
+        }
+        return true;
+    }
+
+    /**
+     * YYYY-MM-DD (str::datef) -> date, false if not valid
+     */
+    constexpr bool parse_date(std::string_view s, date_t &d)
+    {
+        if (s.size() != 10 || s[4] != '-' || s[7] != '-')
+            return false;
+        return parse_uint(s.substr(0, 4), d.year) && parse_uint(s.substr(5, 2), d.month)
+               && parse_uint(s.substr(8, 2), d.day) && valid(d);
+    }
+
+    /**
+     * week files are named "week-%V-%Y.txt" by the day they were created: the ISO week & the *calendar* year,
+     * 2021-01-03 (2020-W53) -> week-53-2021.txt, 2024-12-30 (2025-W01) -> week-01-2024.txt
+     * -> a name may stand for 2 ISO weeks (week-01-2024.txt: 2024-W01 or 2025-W01).
+     * key: the ISO week of the same ISO year (or the only one), alt: the other one (0 -> none),
+     * names by the ISO year (week-53-2020.txt) resolve to the same weeks
+     */
+    struct file_weeks_t {
+        int key {0}; // week key, 0 -> not a week file
+        int alt {0};
+
+        constexpr bool has(int k) const { return k && (k == key || k == alt); }
+        constexpr bool in(int fr, int to) const {
+            return (key && key >= fr && key <= to) || (alt && alt >= fr && alt <= to);
+        }
+    };
+
+    constexpr file_weeks_t weeks_of_name(int week, int year)
+    {
+        file_weeks_t f {};
+        auto add = [&f](const isoweek_t &w) {
+            const int k = week_key(w);
+            if (!f.key)
+                f.key = k;
+            else if (k != f.key)
+                f.alt = k;
+        };
+        if (week >= 1 && week <= weeks_in_year(year))
+            add({ year, week, 1 });
+        const isoweek_t jan1  = isoweek_of(days_of(date_t { year, 1, 1 }));   // W52/W53 of the previous year
+        const isoweek_t dec31 = isoweek_of(days_of(date_t { year, 12, 31 })); // W01 of the next year
+        if (jan1.week == week)
+            add(jan1);
+        if (dec31.week == week)
+            add(dec31);
+        return f;
+    }
+
+    /**
+     * ISO weeks of the week file by its name (directories & compression suffix are allowed):
+     * .../week-05-2021.txt[.gz] -> 2021-W05, nothing if it is not the name of a week file
+     */
+    constexpr file_weeks_t file_weeks(std::string_view fpath)
+    {
+        const std::size_t slash = fpath.find_last_of("/\\");
+        std::string_view name = (slash == std::string_view::npos) ? fpath : fpath.substr(slash + 1);
+        constexpr std::string_view prefix { "week-" }, ext { ".txt" };
+        if (name.size() < 16 || name.substr(0, 5) != prefix || name[7] != '-' || name.substr(12, 4) != ext)
+            return {};
+        int week {0}, year {0};
+        if (!parse_uint(name.substr(5, 2), week) || !parse_uint(name.substr(8, 4), year))
+            return {};
+        return weeks_of_name(week, year);
+    }
+
+    date_t today(); // local date
+    std::string date_str(const date_t &d);           // YYYY-MM-DD
+    std::string file_name(const date_t &d);          // week-%V-%Y.txt of the date
+}
+
+#endif // CAL_HPP
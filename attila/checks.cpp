@@ -0,0 +1,251 @@
+#include <algorithm> // sort
+#include <cstddef>   // size_t
+#include <cstdint>   // uint32_t, uint64_t
+#include <ctime>     // time_t, tm, mktime, strftime
+#include <iostream>  // cout, cerr
+#include <random>
+#include <regex>
+#include <string>
+#include <vector>
+
+#include "attila.hpp"
+#include "cal.hpp"      // ISO week calendar
+#include "dfa.hpp"      // dfa namespace
+#include "interval.hpp" // interval namespace
+#include "query.hpp"    // query namespace
+
+/**
+ * differential checks of the core (ctest -L checks): the fast paths against their plain references
+ *   - DFA matcher vs std::regex on random patterns & lines,
+ *   - implicit interval tree vs scan of all intervals,
+ *   - structured query: operator precedence vs expected tasks, malformed queries are rejected,
+ *   - ISO week calendar vs strftime (%G %V %u) & week file names.
+ * exit code is the number of the failed checks (the first failures of each check are printed)
+ */
+
+namespace
+{
+    constexpr std::size_t max_reported { 10 }; // printed failures per check
+
+    struct check_t {
+        const char *name;
+        std::size_t runs {0};
+        std::size_t failed {0};
+
+        void fail(const std::string &what) {
+            if (failed++ < max_reported)
+                std::cerr << "[Error]: " << name << ": " << what << std::endl;
+        }
+        bool report() const {
+            std::cout << name << ": " << runs << " cases, " << failed << " failed\n";
+            return failed == 0;
+        }
+    };
+
+    class pattern_gen_t {
+    public:
+        explicit pattern_gen_t(std::mt19937 &rng) : rng(rng) {}
+
+        std::string pattern() {
+            std::string p = (pick(4) == 0) ? "^" : "";
+            p += alternation(2);
+            if (pick(4) == 0)
+                p += '$';
+            return p;
+        }
+
+    private:
+        std::size_t pick(std::size_t n) { return std::uniform_int_distribution<std::size_t>(0, n - 1)(rng); }
+
+        std::string alternation(int depth) {
+            std::string p = concatenation(depth);
+            if (pick(3) == 0)
+                p += '|' + concatenation(depth);
+            return p;
+        }
+
+        std::string concatenation(int depth) {
+            std::string p;
+            for (std::size_t i = 0, n = 1 + pick(3); i < n; i++)
+                p += atom(depth) + quantifier();
+            return p;
+        }
+
+        std::string atom(int depth) {
+            static const char *atoms[] {
+                "a", "b", "c", "A", "1", " ", ".", "[ab]", "[^a]", "[a-c]", "\\d", "\\w", "\\s", "\\.", "x"
+            };
+            constexpr std::size_t natoms { sizeof(atoms) / sizeof(atoms[0]) };
+            if (depth > 0 && pick(5) == 0)
+                return '(' + alternation(depth - 1) + ')';
+            return atoms[pick(natoms)];
+        }
+
+        std::string quantifier() {
+            static const char *quantifiers[] { "*", "+", "?", "{2}", "{1,2}", "{0,3}", "*?", "+?", "??" };
+            constexpr std::size_t nquantifiers { sizeof(quantifiers) / sizeof(quantifiers[0]) };
+            return (pick(3) == 0) ? quantifiers[pick(nquantifiers)] : "";
+        }
+
+    private:
+        std::mt19937 &rng;
+    };
+
+    bool dfa_vs_regex(std::mt19937 &rng)
+    {
+        check_t c { "dfa vs std::regex" };
+        pattern_gen_t gen(rng);
+        const std::string alphabet { "abcAB1 .x-" };
+        std::uniform_int_distribution<std::size_t> len(0, 12), ch(0, alphabet.size() - 1);
+        std::size_t unsupported {0};
+        for (int i = 0; i < 2000; i++) {
+            const std::string p = gen.pattern();
+            dfa::matcher_t m(p);
+            if (!m.supported()) {
+                unsupported++;
+                continue;
+            }
+            const std::regex re(p, std::regex::ECMAScript | std::regex::icase);
+            for (int j = 0; j < 50; j++) {
+                std::string s(len(rng), ' ');
+                for (auto &x : s)
+                    x = alphabet[ch(rng)];
+                c.runs++;
+                if (m.search(s) != std::regex_search(s, re))
+                    c.fail("/" + p + "/ on '" + s + "': dfa " + (m.search(s) ? "matches" : "does not match"));
+            }
+        }
+        if (unsupported)
+            std::cout << "dfa vs std::regex: " << unsupported << " generated patterns not supported by the DFA\n";
+        return c.report();
+    }
+
+    bool tree_vs_scan(std::mt19937 &rng)
+    {
+        check_t c { "interval tree vs scan" };
+        std::uniform_int_distribution<std::time_t> at(0, 1000), len(1, 100);
+        for (std::size_t n : { 0, 1, 2, 3, 7, 8, 9, 15, 16, 17, 31, 33, 100, 257, 1000 }) {
+            std::vector<interval::iv_t> ivs(n);
+            for (std::size_t i = 0; i < n; i++) {
+                ivs[i].beg = at(rng);
+                ivs[i].end = ivs[i].beg + len(rng);
+                ivs[i].id  = static_cast<std::uint32_t>(i);
+            }
+            interval::tree_t tree;
+            tree.build(ivs);
+            const std::vector<interval::iv_t> &items = tree.items();
+            for (int q = 0; q < 200; q++) {
+                std::time_t beg = at(rng) - 50, end = beg + len(rng) * (q % 4);
+                std::vector<std::size_t> got, want;
+                tree.query(beg, end, got);
+                for (std::size_t i = 0; i < items.size(); i++)
+                    if (beg < end && items[i].beg < end && beg < items[i].end) // NOTE: empty span -> none
+                        want.push_back(i);
+                std::sort(got.begin(), got.end());
+                c.runs++;
+                if (got != want)
+                    c.fail(std::to_string(n) + " intervals, [" + std::to_string(beg) + ", " + std::to_string(end)
+                           + "): " + std::to_string(got.size()) + " found, " + std::to_string(want.size()) + " expected");
+            }
+        }
+        return c.report();
+    }
+
+    bool query_cases()
+    {
+        check_t c { "query" };
+        const ss::vtasks_t vtt = parse_tasks(
+            "2022-12-26 08:00 - 08:30 [p1] alpha beta\n"
+            "2022-12-26 09:00 - 10:00 [p2] alpha\n"
+            "2022-12-27 10:00 - 10:10 [p1] gamma\n"
+            "2022-12-27 11:00 - 12:30 [p3] beta gamma\n");
+        if (vtt.size() != 4) {
+            c.fail("4 tasks expected, " + std::to_string(vtt.size()) + " parsed");
+            return c.report();
+        }
+        // query -> matching tasks (bit i is the task i)
+        const std::vector<std::pair<std::string, unsigned>> cases {
+            { "",                         0b1111 },
+            { "alpha",                    0b0011 },
+            { "alpha beta",               0b0001 },
+            { "alpha | gamma beta",       0b1011 }, // AND binds tighter than OR
+            { "alpha and beta or gamma",  0b1101 },
+            { "(alpha | gamma) beta",     0b1001 },
+            { "-alpha beta",              0b1000 }, // NOT binds tighter than AND
+            { "not (alpha | beta)",       0b0100 },
+            { "not not alpha",            0b0011 },
+            { "p:p1 | p:p3 -gamma",       0b0101 },
+            { "p:p1 d>20m",               0b0001 },
+            { "d>=30m d<=60m",            0b0011 },
+            { "date:2022-12-27 | p:p2",   0b1110 },
+            { "text~ha$ | t~^\\[p3",      0b1010 }, // NOTE: text starts with the projects
+        };
+        for (const auto &[q, want] : cases) {
+            query::filter_t f(q);
+            c.runs++;
+            if (!f.ok()) {
+                c.fail("'" + q + "' rejected: " + f.error());
+                continue;
+            }
+            unsigned got {0};
+            for (std::size_t i = 0; i < vtt.size(); i++)
+                got |= unsigned(f.match(vtt[i])) << i;
+            unsigned filtered {0};
+            for (const auto &t : f.filter(vtt))
+                for (std::size_t i = 0; i < vtt.size(); i++)
+                    filtered |= unsigned(t.text == vtt[i].text && t.hm_t.beg == vtt[i].hm_t.beg) << i;
+            if (got != want || filtered != want)
+                c.fail("'" + q + "' selects " + std::to_string(got) + " (filter " + std::to_string(filtered)
+                       + "), expected " + std::to_string(want));
+        }
+        const std::vector<std::string> malformed {
+            "(alpha", "alpha)", "()", "alpha ()", "alpha |", "| alpha", "alpha | | beta", "not",
+            "\"alpha", "d>abc", "d~30m", "wd:xyz", "wd>mon", "text~(", "p:",
+        };
+        for (const auto &q : malformed) {
+            c.runs++;
+            if (query::filter_t(q).ok())
+                c.fail("'" + q + "' accepted");
+        }
+        return c.report();
+    }
+
+    bool calendar_vs_strftime()
+    {
+        check_t c { "calendar vs strftime" };
+        const int fr = cal::days_of(cal::date_t { 1970, 1, 2 }); // NOTE: mktime of the earlier dates may fail
+        const int to = cal::days_of(cal::date_t { 2100, 12, 31 });
+        for (int days = fr; days <= to; days++) {
+            const cal::date_t d = cal::date_of(days);
+            const cal::isoweek_t w = cal::isoweek_of(days);
+            std::tm tm {};
+            tm.tm_year  = d.year - 1900;
+            tm.tm_mon   = d.month - 1;
+            tm.tm_mday  = d.day;
+            tm.tm_hour  = 12; // NOTE: far from the midnight -> the same day in any time zone & DST
+            tm.tm_isdst = -1;
+            std::mktime(&tm); // -> weekday & day of the year used by %G %V %u
+            char buf[32];
+            std::strftime(buf, sizeof(buf), "%G %V %u", &tm);
+            const std::string want(buf);
+            const std::string got = std::to_string(w.year) + ' ' + ((w.week < 10) ? "0" : "")
+                                  + std::to_string(w.week) + ' ' + std::to_string(w.wday);
+            c.runs++;
+            if (got != want || tm.tm_mday != d.day || cal::days_of(d) != days || cal::days_of(w) != days
+                    || !cal::file_weeks(cal::file_name(d)).has(cal::week_key(w)))
+                c.fail(cal::date_str(d) + ": " + got + ", strftime " + want + ", file " + cal::file_name(d));
+        }
+        return c.report();
+    }
+}
+
+int main()
+{
+    std::mt19937 rng(20221226); // NOTE: fixed seed -> the same cases on every run
+    int failed {0};
+    failed += !dfa_vs_regex(rng);
+    failed += !tree_vs_scan(rng);
+    failed += !query_cases();
+    failed += !calendar_vs_strftime();
+    return failed;
+}
@@ -0,0 +1,465 @@
+#include <algorithm> // sort
+#include <cctype>    // tolower, toupper, isalnum
+#include <cstddef>   // size_t
+#include <string>
+#include <string_view>
+#include <utility>   // move
+#include <vector>
+
+#include "dfa.hpp"
+
+using byteset_t = dfa::matcher_t::byteset_t;
+using nstate_t  = dfa::matcher_t::nstate_t;
+using mt        = dfa::matcher_t;
+
+namespace
+{
+    constexpr std::size_t max_nstates { 10000 }; // bounded repeats expansion limit
+    constexpr std::size_t max_dstates { 1024 };  // DFA cache limit (~1KiB per state)
+
+    struct node_t {
+        enum kind_t { SET, CAT, ALT, REP, BOL, EOL } kind;
+        byteset_t set {};
+        std::vector<node_t> kids {};
+        int min {0};
+        int max {-1}; // -1 -> unbounded
+    };
+
+    byteset_t range(unsigned char fr, unsigned char to)
+    {
+        byteset_t s;
+        for (unsigned c = fr; c <= to; c++)
+            s.set(c);
+        return s;
+    }
+
+    byteset_t digit() { return range('0', '9'); }
+    byteset_t word()  { return range('a', 'z') | range('A', 'Z') | digit() | range('_', '_'); }
+    byteset_t space() {
+        byteset_t s;
+        for (unsigned char c : std::string(" \t\n\r\f\v"))
+            s.set(c);
+        return s;
+    }
+
+    /**
+     * recursive descent parser of the supported ECMAScript subset into the AST
+     */
+    class parser_t {
+    public:
+        parser_t(const std::string &p, bool icase) : p(p), icase(icase) {}
+
+        bool parse(node_t &root) {
+            root = alt();
+            return ok && pos == p.size();
+        }
+
+    private:
+        bool more() const { return ok && pos < p.size(); }
+
+        node_t fail() { ok = false; return { node_t::CAT }; }
+
+        node_t alt() {
+            node_t n { node_t::ALT };
+            n.kids.push_back(cat());
+            while (more() && p[pos] == '|') {
+                pos++;
+                n.kids.push_back(cat());
+            }
+            if (n.kids.size() == 1)
+                return std::move(n.kids[0]);
+            return n;
+        }
+
+        node_t cat() {
+            node_t n { node_t::CAT };
+            while (more() && p[pos] != '|' && p[pos] != ')')
+                n.kids.push_back(repeat());
+            return n;
+        }
+
+        node_t repeat() {
+            node_t a = atom();
+            if (!more())
+                return a;
+            int min, max;
+            switch (p[pos]) {
+            case '*': min = 0; max = -1; pos++; break;
+            case '+': min = 1; max = -1; pos++; break;
+            case '?': min = 0; max =  1; pos++; break;
+            case '{': if (!braces(min, max)) return fail(); break;
+            default: return a;
+            }
+            if (a.kind == node_t::BOL || a.kind == node_t::EOL)
+                return fail(); // quantified assertion
+            if (more() && p[pos] == '?')
+                pos++; // lazy quantifier -> same language, irrelevant for the search
+            if (more() && (p[pos] == '*' || p[pos] == '+' || p[pos] == '?' || p[pos] == '{'))
+                return fail(); // nothing to repeat
+            node_t n { node_t::REP };
+            n.min = min;
+            n.max = max;
+            n.kids.push_back(std::move(a));
+            return n;
+        }
+
+        // {n} {n,} {n,m}
+        bool braces(int &min, int &max) {
+            pos++; // {
+            if (!number(min))
+                return false;
+            max = min;
+            if (pos < p.size() && p[pos] == ',') {
+                pos++;
+                max = -1;
+                if (pos < p.size() && p[pos] != '}' && !number(max))
+                    return false;
+            }
+            if (pos >= p.size() || p[pos] != '}' || (max != -1 && max < min))
+                return false;
+            pos++; // }
+            return true;
+        }
+
+        bool number(int &n) {
+            std::size_t beg = pos;
+            n = 0;
+            while (pos < p.size() && std::isdigit(static_cast<unsigned char>(p[pos])) && n < 100000)
+                n = n * 10 + (p[pos++] - '0');
+            return pos != beg && n < 100000;
+        }
+
+        node_t atom() {
+            const char c = p[pos++];
+            node_t n { node_t::SET };
+            switch (c) {
+            case '(':
+                if (pos < p.size() && p[pos] == '?') {
+                    if (pos + 1 < p.size() && p[pos + 1] == ':')
+                        pos += 2; // non-capturing group
+                    else
+                        return fail(); // lookaround & named groups are not supported
+                }
+                n = alt();
+                if (!more() || p[pos] != ')')
+                    return fail();
+                pos++;
+                return n;
+            case '[':
+                if (!cclass(n.set))
+                    return fail();
+                return n;
+            case '.':
+                n.set.set();
+                n.set.reset('\n');
+                n.set.reset('\r');
+                return n;
+            case '^': return { node_t::BOL };
+            case '$': return { node_t::EOL };
+            case '\\':
+                if (!escape(n.set, false))
+                    return fail();
+                return n;
+            case '*': case '+': case '?': case '{': case '}': case ']': case ')':
+                return fail();
+            default:
+                n.set.set(static_cast<unsigned char>(c));
+                fold(n.set);
+                return n;
+            }
+        }
+
+        // escape after the backslash, single character escape is also returned through the `ch`
+        bool escape(byteset_t &s, bool in_class, int *ch = nullptr) {
+            if (pos >= p.size())
+                return false;
+            const unsigned char c = p[pos++];
+            int lit = -1;
+            switch (c) {
+            case 'd': s |= digit();  break;
+            case 'D': s |= ~digit(); break;
+            case 'w': s |= word();   break;
+            case 'W': s |= ~word();  break;
+            case 's': s |= space();  break;
+            case 'S': s |= ~space(); break;
+            case 'n': lit = '\n'; break;
+            case 't': lit = '\t'; break;
+            case 'r': lit = '\r'; break;
+            case 'f': lit = '\f'; break;
+            case 'v': lit = '\v'; break;
+            case 'b':
+                if (!in_class)
+                    return false; // word boundary
+                lit = '\b';
+                break;
+            default:
+                // identity escape of the syntax characters only
+                // (backrefs, \x \u \c \k \B ... are not supported)
+                if (std::isalnum(c) || c >= 0x80)
+                    return false;
+                lit = c;
+            }
+            if (lit != -1) {
+                s.set(static_cast<unsigned char>(lit));
+                fold(s);
+            }
+            if (ch)
+                *ch = lit;
+            return true;
+        }
+
+        bool cclass(byteset_t &s) {
+            bool negate = false;
+            if (pos < p.size() && p[pos] == '^') {
+                negate = true;
+                pos++;
+            }
+            byteset_t cs;
+            while (pos < p.size() && p[pos] != ']') {
+                int lo = static_cast<unsigned char>(p[pos++]);
+                if (lo == '\\' && !escape(cs, true, &lo))
+                    return false;
+                if (lo == -1)
+                    continue; // class escape (\d \w ...)
+                if (pos + 1 < p.size() && p[pos] == '-' && p[pos + 1] != ']') {
+                    pos++; // -
+                    int hi = static_cast<unsigned char>(p[pos++]);
+                    if (hi == '\\' && !escape(cs, true, &hi))
+                        return false;
+                    if (hi == -1 || hi < lo)
+                        return false;
+                    cs |= range(lo, hi);
+                } else {
+                    cs.set(lo);
+                }
+            }
+            if (pos >= p.size())
+                return false; // not closed class
+            pos++; // ]
+            fold(cs);
+            s = (negate) ? ~cs : cs;
+            return true;
+        }
+
+        // case insensitive -> both cases of the letters are in the set
+        void fold(byteset_t &s) const {
+            if (!icase)
+                return;
+            for (unsigned c = 'a'; c <= 'z'; c++) {
+                const unsigned u = std::toupper(c);
+                if (s[c] || s[u]) {
+                    s.set(c);
+                    s.set(u);
+                }
+            }
+        }
+
+    private:
+        const std::string &p;
+        const bool icase;
+        std::size_t pos {0};
+        bool ok {true};
+    };
+
+    /**
+     * AST -> Thompson NFA, compiled backwards: each node is compiled
+     * with the already known continuation state & returns its start state
+     */
+    class compiler_t {
+    public:
+        compiler_t(std::vector<nstate_t> &nstates, std::vector<byteset_t> &sets)
+            : nstates(nstates), sets(sets) {}
+
+        bool ok() const { return nstates.size() <= max_nstates; }
+
+        int compile(const node_t &n, int next) {
+            if (!ok())
+                return next;
+            switch (n.kind) {
+            case node_t::SET:
+                sets.push_back(n.set);
+                return add({ mt::SET, static_cast<int>(sets.size()) - 1, next });
+            case node_t::BOL:
+                return add({ mt::BOL, -1, next });
+            case node_t::EOL:
+                return add({ mt::EOL, -1, next });
+            case node_t::CAT:
+                for (auto it = n.kids.rbegin(); it != n.kids.rend(); ++it)
+                    next = compile(*it, next);
+                return next;
+            case node_t::ALT: {
+                int s = compile(n.kids.back(), next);
+                for (int i = static_cast<int>(n.kids.size()) - 2; i >= 0; i--)
+                    s = add({ mt::SPLIT, -1, compile(n.kids[i], next), s });
+                return s;
+            }
+            case node_t::REP: {
+                const node_t &kid = n.kids[0];
+                int tail = next;
+                if (n.max == -1) { // x* loop
+                    const int loop = add({ mt::SPLIT, -1, -1, next });
+                    const int body = compile(kid, loop);
+                    nstates[loop].out = body;
+                    tail = loop;
+                } else { // optional copies: (x(x)?)?
+                    for (int i = n.min; i < n.max && ok(); i++)
+                        tail = add({ mt::SPLIT, -1, compile(kid, tail), next });
+                }
+                for (int i = 0; i < n.min && ok(); i++)
+                    tail = compile(kid, tail);
+                return tail;
+            }
+            }
+            return next;
+        }
+
+    private:
+        int add(nstate_t s) {
+            nstates.push_back(s);
+            return static_cast<int>(nstates.size()) - 1;
+        }
+
+        std::vector<nstate_t>  &nstates;
+        std::vector<byteset_t> &sets;
+    };
+}
+
+dfa::matcher_t::matcher_t(const std::string &pattern, bool icase)
+{
+    node_t root { node_t::CAT };
+    parser_t parser(pattern, icase);
+    if (!parser.parse(root))
+        return; // not supported -> ok == false
+    nstates.push_back({ MATCH });
+    compiler_t compiler(nstates, sets);
+    start = compiler.compile(root, 0);
+    if (!compiler.ok())
+        return;
+    mark.assign(nstates.size(), 0);
+    std::vector<int> stack { start };
+    std::vector<int> nset;
+    closure(stack, true, false, nset);
+    add_dstate(std::move(nset), true);
+    ok = true;
+}
+
+/**
+ * epsilon closure of the states in the stack
+ * (SET/MATCH/EOL states are kept in the set, SPLIT & passed assertions are followed)
+ */
+void dfa::matcher_t::closure(std::vector<int> &stack, bool bol, bool eol, std::vector<int> &nset)
+{
+    if (++gen == 0) { // wrap around of the marks generation
+        std::fill(mark.begin(), mark.end(), 0);
+        gen = 1;
+    }
+    nset.clear();
+    while (!stack.empty()) {
+        const int i = stack.back();
+        stack.pop_back();
+        if (mark[i] == gen)
+            continue;
+        mark[i] = gen;
+        const nstate_t &ns = nstates[i];
+        switch (ns.type) {
+        case SPLIT:
+            stack.push_back(ns.out1);
+            stack.push_back(ns.out);
+            break;
+        case BOL:
+            if (bol)
+                stack.push_back(ns.out);
+            break; // not at the beginning of the line -> dead branch
+        case EOL:
+            if (eol)
+                stack.push_back(ns.out);
+            else
+                nset.push_back(i); // pending until the end of the line
+            break;
+        case SET:
+        case MATCH:
+            nset.push_back(i);
+            break;
+        }
+    }
+    std::sort(nset.begin(), nset.end());
+}
+
+int dfa::matcher_t::add_dstate(std::vector<int> &&nset, bool initial)
+{
+    if (!initial) {
+        const auto it = dcache.find(nset);
+        if (it != dcache.end())
+            return it->second;
+        if (dstates.size() >= max_dstates) {
+            // cache is full -> flush it, keep only the initial state
+            dstates.resize(1);
+            dstates[0].next.fill(-1);
+            dcache.clear();
+        }
+    }
+    dstate_t ds {};
+    ds.next.fill(-1);
+    ds.match = std::binary_search(nset.begin(), nset.end(), 0); // MATCH is state 0
+    ds.nset = nset;
+    dstates.push_back(std::move(ds));
+    const int id = static_cast<int>(dstates.size()) - 1;
+    if (!initial)
+        dcache.emplace(std::move(nset), id);
+    return id;
+}
+
+/**
+ * build the transition of the DFA state by the byte
+ */
+int dfa::matcher_t::step(int ds, unsigned char c)
+{
+    std::vector<int> stack { start }; // unanchored search -> match can start at any position
+    for (const int i : dstates[ds].nset) {
+        const nstate_t &ns = nstates[i];
+        if (ns.type == SET && sets[ns.set][c])
+            stack.push_back(ns.out);
+    }
+    std::vector<int> nset;
+    closure(stack, false, false, nset);
+    const std::size_t before = dstates.size();
+    const int next = add_dstate(std::move(nset), false);
+    if (dstates.size() >= before) // NOTE: source state is gone if the cache was flushed
+        dstates[ds].next[c] = next;
+    return next;
+}
+
+bool dfa::matcher_t::eol_match(int ds)
+{
+    dstate_t &d = dstates[ds];
+    if (d.eol_match == -1) {
+        std::vector<int> stack;
+        for (const int i : d.nset)
+            if (nstates[i].type == EOL)
+                stack.push_back(nstates[i].out);
+        std::vector<int> nset;
+        closure(stack, ds == 0, true, nset); // initial state -> empty line
+        d.eol_match = std::binary_search(nset.begin(), nset.end(), 0);
+    }
+    return d.eol_match;
+}
+
+/**
+ * whether the pattern matches any part of the line
+ */
+bool dfa::matcher_t::search(std::string_view s)
+{
+    int ds = 0;
+    if (dstates[ds].match)
+        return true;
+    for (const char ch : s) {
+        const unsigned char c = static_cast<unsigned char>(ch);
+        int next = dstates[ds].next[c];
+        if (next < 0)
+            next = step(ds, c);
+        ds = next;
+        if (dstates[ds].match)
+            return true;
+    }
+    return eol_match(ds);
+}
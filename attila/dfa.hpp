@@ -0,0 +1,70 @@
+#ifndef DFA_HPP
+#define DFA_HPP
+
+#include <array>
+#include <bitset>
+#include <cstddef> // size_t
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace dfa
+{
+    /**
+     * linear time regex matcher: pattern -> Thompson NFA -> lazily built DFA.
+     *
+     * supports the common subset of the ECMAScript syntax:
+     * literals, escapes (\d \w \s ...), classes, groups, alternation,
+     * greedy/lazy quantifiers, bounded repeats & ^ $ anchors.
+     * patterns with other features (backrefs, lookarounds, word boundaries, ...)
+     * are not compiled -> supported() == false & the caller should fall back to std::regex.
+     *
+     * DFA states are built on demand while searching & cached,
+     * each byte of the input costs one table lookup -> no backtracking.
+     */
+    class matcher_t {
+    public:
+        explicit matcher_t(const std::string &pattern, bool icase = true);
+
+        bool supported() const { return ok; }
+        bool search(std::string_view s); // NOTE: not const -> extends the DFA cache
+
+        enum ntype_t { SET, SPLIT, BOL, EOL, MATCH };
+
+        struct nstate_t {
+            ntype_t type;
+            int set  {-1}; // index of the byte set (SET)
+            int out  {-1};
+            int out1 {-1}; // second branch (SPLIT)
+        };
+
+        using byteset_t = std::bitset<256>;
+
+    private:
+        struct dstate_t {
+            std::vector<int> nset;   // sorted NFA states
+            std::array<int, 256> next;
+            bool match;              // MATCH state is reachable -> found
+            int  eol_match { -1 };   // match at the end of the line (-1 not yet computed)
+        };
+
+        void closure(std::vector<int> &stack, bool bol, bool eol, std::vector<int> &nset);
+        int  add_dstate(std::vector<int> &&nset, bool initial);
+        int  step(int ds, unsigned char c);
+        bool eol_match(int ds);
+
+    private:
+        bool ok { false };
+        int  start { -1 };
+        std::vector<nstate_t>  nstates;
+        std::vector<byteset_t> sets;
+
+        std::vector<dstate_t> dstates; // [0] is the initial state (at the beginning of the line)
+        std::map<std::vector<int>, int> dcache;
+        std::vector<unsigned> mark;    // visited marks of the epsilon closure
+        unsigned gen { 0 };
+    };
+}
+
+#endif // DFA_HPP
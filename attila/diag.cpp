@@ -0,0 +1,105 @@
+#include <algorithm> // sort, min
+#include <string>
+#include <vector>
+
+#include <fmt/core.h>
+
+#include "diag.hpp"
+
+void diag::log_t::add(std::size_t nl, diag::reason_t r) noexcept
+{
+    counts[static_cast<std::size_t>(r)]++;
+    if (nsamples < max_samples)
+        samples_[nsamples++] = { file, static_cast<std::uint32_t>(first_line + nl + 1), r };
+}
+
+void diag::log_t::merge(const diag::log_t &other)
+{
+    const std::uint64_t n = other.total();
+    if (!n)
+        return;
+    if (per_file.empty())
+        per_file = file_counts(); // lines added to this log so far
+    for (std::size_t r = 0; r < nreasons; r++)
+        counts[r] += other.counts[r];
+    for (std::size_t i = 0; i < other.nsamples && nsamples < max_samples; i++)
+        samples_[nsamples++] = other.samples_[i];
+    const std::vector<std::uint64_t> of = other.file_counts();
+    if (per_file.size() < of.size())
+        per_file.resize(of.size(), 0);
+    for (std::size_t f = 0; f < of.size(); f++)
+        per_file[f] += of[f];
+}
+
+std::uint64_t diag::log_t::total() const
+{
+    std::uint64_t n {0};
+    for (const auto c : counts)
+        n += c;
+    return n;
+}
+
+std::vector<diag::sample_t> diag::log_t::samples() const
+{
+    std::vector<diag::sample_t> v(samples_.begin(), samples_.begin() + nsamples);
+    std::sort(v.begin(), v.end(), [](const auto &a, const auto &b) {
+        return (a.file != b.file) ? a.file < b.file : a.line < b.line;
+    });
+    return v;
+}
+
+std::vector<std::uint64_t> diag::log_t::file_counts() const
+{
+    if (!per_file.empty() || !total())
+        return per_file;
+    std::vector<std::uint64_t> v(file + 1, 0); // not merged -> lines of its own file
+    v[file] = total();
+    return v;
+}
+
+const char *diag::reason_str(diag::reason_t r)
+{
+    switch (r) {
+    case reason_t::NO_TASK:      return "no time span and/or task text";
+    case reason_t::NO_TIME_SPAN: return "date and/or time span is not valid";
+    }
+    return "?";
+}
+
+std::string diag::summary(const diag::log_t &log)
+{
+    std::string out { fmt::format("{} lines skipped", log.total()) };
+    const char *sep = " (";
+    for (std::size_t r = 0; r < nreasons; r++) {
+        const auto reason = static_cast<diag::reason_t>(r);
+        if (!log.count(reason))
+            continue;
+        out += fmt::format("{}{}: {}", sep, diag::reason_str(reason), log.count(reason));
+        sep = ", ";
+    }
+    if (log.total())
+        out += ')';
+    return out;
+}
+
+std::string diag::report(const diag::log_t &log, const std::vector<std::string> &fpaths)
+{
+    auto fname = [&](std::uint32_t f) -> std::string {
+        return (f < fpaths.size()) ? fpaths[f] : "line";
+    };
+    std::string out { "parse diagnostics: " + diag::summary(log) + '\n' };
+    if (!log.total())
+        return out;
+    const std::vector<std::uint64_t> fc = log.file_counts();
+    if (!fpaths.empty()) {
+        for (std::size_t f = 0; f < fc.size(); f++)
+            if (fc[f])
+                out += fmt::format("  {}: {}\n", fname(static_cast<std::uint32_t>(f)), fc[f]);
+    }
+    const std::vector<diag::sample_t> samples = log.samples();
+    for (const auto &s : samples)
+        out += fmt::format("  {}:{}: {}\n", fname(s.file), s.line, diag::reason_str(s.reason));
+    if (samples.size() < log.total())
+        out += fmt::format("  ... first {} of {} lines\n", samples.size(), log.total());
+    return out;
+}
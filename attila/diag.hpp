@@ -0,0 +1,64 @@
+#ifndef DIAG_HPP
+#define DIAG_HPP
+
+#include <array>
+#include <cstddef> // size_t
+#include <cstdint> // uint8_t, uint32_t, uint64_t
+#include <string>
+#include <vector>
+
+namespace diag
+{
+    /**
+     * parse diagnostics: lines which are not tasks are returned by the parser as values
+     * & recorded into the log of the parsing thread (no exceptions, no output, no locks, no allocation).
+     * the log keeps the counts per reason & the first max_samples lines (file, line number, reason),
+     * logs of the threads are merged when their chunks are joined (counts per file are kept from then on).
+     */
+    enum class reason_t : std::uint8_t { NO_TASK, NO_TIME_SPAN };
+    constexpr std::size_t nreasons    { 2 };
+    constexpr std::size_t max_samples { 64 };
+
+    struct sample_t {
+        std::uint32_t  file;   // index of the file in the span (ss::span_t::fpaths)
+        std::uint32_t  line;   // line number in the file (from 1)
+        diag::reason_t reason;
+    };
+
+    class log_t {
+    public:
+        log_t() = default;
+        /**
+         * log of the lines of one file, line 0 of the parsed text is the line first_line + 1 of the file
+         */
+        log_t(std::uint32_t file, std::size_t first_line) : file(file), first_line(first_line) {}
+
+        log_t fork() const { return log_t(file, first_line); } // empty log of the same text (for a thread)
+        void add(std::size_t nl, diag::reason_t r) noexcept; // nl: line of the parsed text (from 0)
+        void merge(const diag::log_t &other);
+
+        std::uint64_t total() const;
+        std::uint64_t count(diag::reason_t r) const { return counts[static_cast<std::size_t>(r)]; }
+        std::vector<diag::sample_t> samples() const;     // in the order of the files & lines
+        std::vector<std::uint64_t>  file_counts() const; // by the file index
+
+    private:
+        std::uint32_t file {0};
+        std::size_t   first_line {0};
+        std::array<std::uint64_t, nreasons> counts {};
+        std::array<diag::sample_t, max_samples> samples_ {};
+        std::size_t nsamples {0};
+        std::vector<std::uint64_t> per_file {}; // only in the merged logs
+    };
+
+    const char *reason_str(diag::reason_t r);
+
+    /**
+     * summary line with the counts per reason, counts per file & the sampled lines:
+     * path:line: reason (files are the file paths of the span, line of the text if not known)
+     */
+    std::string report(const diag::log_t &log, const std::vector<std::string> &fpaths);
+    std::string summary(const diag::log_t &log);
+}
+
+#endif // DIAG_HPP
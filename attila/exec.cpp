@@ -0,0 +1,322 @@
+#include <algorithm> // max
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>   // getenv
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>    // unique_ptr
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>   // move
+#include <vector>
+
+#ifdef __linux__
+#include <pthread.h> // pthread_setaffinity_np
+#include <sched.h>   // cpu_set_t
+#endif
+
+#include "exec.hpp"
+#include "mem.hpp"   // heap accounting per stage
+
+using exec::lane_t;
+
+namespace
+{
+    struct item_t {
+        std::function<void()> job {};
+        lane_t       lane  { lane_t::NORMAL };
+        mem::stage_t stage { mem::stage_t::OTHER }; // heap accounting stage of the submitting thread
+    };
+
+    using lanes_t = std::array<std::deque<item_t>, exec::nlanes>;
+
+    struct worker_t {
+        std::mutex  mtx;
+        lanes_t     q;
+        std::thread th;
+    };
+
+    class pool_t;
+    thread_local pool_t *tls_pool   { nullptr }; // pool of the worker
+    thread_local std::size_t tls_worker { 0 };   // index of the worker in its pool
+    thread_local lane_t tls_lane { lane_t::NORMAL };
+
+    void run(item_t &it)
+    {
+        const lane_t prev = tls_lane;
+        tls_lane = it.lane;
+        {
+            const mem::scope_t mscope(it.stage);
+            it.job(); // NOTE: packaged task -> exceptions go to the future
+        }
+        tls_lane = prev;
+    }
+
+    class pool_t {
+    public:
+        explicit pool_t(const exec::config_t &c) {
+            const std::size_t n = (c.threads) ? c.threads : std::max(1u, std::thread::hardware_concurrency());
+            for (std::size_t i = 0; i < n; i++)
+                workers.push_back(std::make_unique<worker_t>());
+            for (std::size_t i = 0; i < n; i++) {
+                workers[i]->th = std::thread([this, i]() { work(i); });
+                pin(workers[i]->th, c.cpus, i);
+            }
+            for (std::size_t i = 0; i < std::max<std::size_t>(1, c.io_threads); i++)
+                io_workers.emplace_back([this]() { work_io(); });
+        }
+
+        ~pool_t() {
+            {
+                std::lock_guard<std::mutex> lk(mtx);
+                stop = true;
+            }
+            cv.notify_all();
+            {
+                std::lock_guard<std::mutex> lk(io_mtx);
+                io_stop = true;
+            }
+            io_cv.notify_all();
+            for (auto &w : workers)
+                w->th.join();
+            for (auto &t : io_workers)
+                t.join();
+        }
+
+        std::size_t size() const { return workers.size(); }
+        std::size_t io_size() const { return io_workers.size(); }
+
+        void post(item_t &&it) {
+            const std::size_t l = static_cast<std::size_t>(it.lane);
+            if (tls_pool == this) {
+                worker_t &w = *workers[tls_worker];
+                std::lock_guard<std::mutex> lk(w.mtx);
+                w.q[l].push_back(std::move(it));
+                pending.fetch_add(1);
+            } else {
+                std::lock_guard<std::mutex> lk(mtx);
+                injected[l].push_back(std::move(it));
+                pending.fetch_add(1);
+            }
+            { std::lock_guard<std::mutex> lk(mtx); } // NOTE: a worker is either waiting or sees pending
+            cv.notify_one();
+        }
+
+        void post_io(item_t &&it) {
+            {
+                std::lock_guard<std::mutex> lk(io_mtx);
+                io_q.push_back(std::move(it));
+            }
+            io_cv.notify_one();
+        }
+
+        /**
+         * job of the highest lane: own deque (newest first), then submitted from outside, then stolen (oldest first),
+         * lanes below the lowest are not taken
+         */
+        bool take(std::size_t self, item_t &it, lane_t lowest = lane_t::BACKGROUND) {
+            if (pending.load() == 0)
+                return false;
+            auto pop = [&](std::deque<item_t> &q, bool back) {
+                if (q.empty())
+                    return false;
+                if (back) {
+                    it = std::move(q.back());
+                    q.pop_back();
+                } else {
+                    it = std::move(q.front());
+                    q.pop_front();
+                }
+                pending.fetch_sub(1);
+                return true;
+            };
+            const std::size_t n = workers.size();
+            for (std::size_t l = 0; l <= static_cast<std::size_t>(lowest); l++) {
+                {
+                    std::lock_guard<std::mutex> lk(workers[self]->mtx);
+                    if (pop(workers[self]->q[l], true))
+                        return true;
+                }
+                {
+                    std::lock_guard<std::mutex> lk(mtx);
+                    if (pop(injected[l], false))
+                        return true;
+                }
+                for (std::size_t i = 1; i < n; i++) {
+                    worker_t &victim = *workers[(self + i) % n];
+                    std::lock_guard<std::mutex> lk(victim.mtx);
+                    if (pop(victim.q[l], false))
+                        return true;
+                }
+            }
+            return false;
+        }
+
+    private:
+        void work(std::size_t self) {
+            tls_pool = this;
+            tls_worker = self;
+            item_t it;
+            for (;;) {
+                if (take(self, it)) {
+                    run(it);
+                    it = {};
+                    continue;
+                }
+                std::unique_lock<std::mutex> lk(mtx);
+                cv.wait(lk, [&]{ return stop || pending.load() > 0; });
+                if (stop)
+                    return; // NOTE: pending jobs are dropped -> their futures get broken_promise
+            }
+        }
+
+        void work_io() {
+            for (;;) {
+                item_t it;
+                {
+                    std::unique_lock<std::mutex> lk(io_mtx);
+                    io_cv.wait(lk, [&]{ return io_stop || !io_q.empty(); });
+                    if (io_stop)
+                        return;
+                    it = std::move(io_q.front());
+                    io_q.pop_front();
+                }
+                run(it);
+            }
+        }
+
+        static void pin(std::thread &th, const std::vector<int> &cpus, std::size_t i) {
+#ifdef __linux__
+            if (cpus.empty())
+                return;
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(cpus[i % cpus.size()], &set);
+            pthread_setaffinity_np(th.native_handle(), sizeof(set), &set);
+#else
+            (void)th; (void)cpus; (void)i;
+#endif
+        }
+
+    private:
+        std::vector<std::unique_ptr<worker_t>> workers;
+        std::mutex mtx; // of the injected jobs & sleeping of the workers
+        std::condition_variable cv;
+        lanes_t injected;
+        std::atomic<std::size_t> pending {0};
+        bool stop {false};
+
+        std::vector<std::thread> io_workers;
+        std::mutex io_mtx;
+        std::condition_variable io_cv;
+        std::deque<item_t> io_q;
+        bool io_stop {false};
+    };
+
+    std::mutex config_mtx;
+    exec::config_t config { exec::config_from_env() };
+    std::atomic<bool> started {false};
+
+    pool_t &pool()
+    {
+        static pool_t p([]() {
+            std::lock_guard<std::mutex> lk(config_mtx);
+            started = true;
+            return config;
+        }());
+        return p;
+    }
+}
+
+bool exec::parse_cpus(const std::string &list, std::vector<int> &cpus)
+{
+    cpus.clear();
+    std::istringstream ls(list);
+    std::string range;
+    while (std::getline(ls, range, ',')) {
+        if (range.empty())
+            continue;
+        const std::size_t dash = range.find('-');
+        try {
+            const int a = std::stoi(range.substr(0, dash));
+            const int b = (dash == std::string::npos) ? a : std::stoi(range.substr(dash + 1));
+            if (a < 0 || b < a)
+                return false;
+            for (int c = a; c <= b; c++)
+                cpus.push_back(c);
+        } catch (const std::exception &) {
+            return false;
+        }
+    }
+    return true;
+}
+
+exec::config_t exec::config_from_env()
+{
+    exec::config_t c;
+    if (const char *threads = std::getenv("ATTILA_THREADS")) {
+        try {
+            c.threads = std::stoul(threads);
+        } catch (const std::exception &) {
+            c.threads = 0;
+        }
+    }
+    if (const char *cpus = std::getenv("ATTILA_CPUS"))
+        if (!exec::parse_cpus(cpus, c.cpus))
+            c.cpus.clear();
+    return c;
+}
+
+bool exec::configure(const exec::config_t &c)
+{
+    std::lock_guard<std::mutex> lk(config_mtx);
+    if (started)
+        return false;
+    config = c;
+    return true;
+}
+
+std::size_t exec::workers()
+{
+    return pool().size();
+}
+
+std::size_t exec::io_threads()
+{
+    return pool().io_size();
+}
+
+exec::lane_t exec::current_lane()
+{
+    return tls_lane;
+}
+
+void exec::detail::post(exec::lane_t lane, std::function<void()> job)
+{
+    pool().post({ std::move(job), lane, mem::stage() });
+}
+
+void exec::detail::post_io(std::function<void()> job)
+{
+    pool().post_io({ std::move(job), lane_t::NORMAL, mem::stage() });
+}
+
+bool exec::detail::on_worker()
+{
+    return tls_pool != nullptr;
+}
+
+bool exec::detail::help_one(exec::lane_t lowest)
+{
+    if (!tls_pool)
+        return false;
+    item_t it;
+    if (!tls_pool->take(tls_worker, it, lowest))
+        return false;
+    run(it);
+    return true;
+}
@@ -0,0 +1,127 @@
+#ifndef EXEC_HPP
+#define EXEC_HPP
+
+#include <chrono>
+#include <cstddef> // size_t
+#include <cstdint> // uint8_t
+#include <functional>
+#include <future>
+#include <memory>  // shared_ptr
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility> // move, forward
+#include <vector>
+
+namespace exec
+{
+    /**
+     * one work-stealing thread pool for the whole app (created on the first use):
+     * - CPU workers with three priority lanes: interactive (filtering as you type, the latest day),
+     *   normal (default, batch) & background (loading of the whole span).
+     *   jobs of a higher lane are always taken first; each worker has its own deque per lane
+     *   (own jobs newest first, idle workers steal the oldest jobs of the others).
+     *   jobs submitted by a job go to the deque of its worker & inherit its lane.
+     * - blocking I/O threads (reading of the week files): waiting for the disk does not occupy the workers.
+     * waiting for a job on a worker runs the other pending jobs of its lane or of the higher ones meanwhile
+     * -> nested parallel loops (load -> parse chunks) do not deadlock with any number of workers
+     * & the awaited job is not delayed by a job of a lower lane (priority inversion).
+     * configured by configure() before the first use, or by the environment:
+     *   ATTILA_THREADS=N (workers, default: hardware concurrency), ATTILA_CPUS=0-3,6 (affinity, Linux)
+     */
+    enum class lane_t : std::uint8_t { INTERACTIVE, NORMAL, BACKGROUND };
+    constexpr std::size_t nlanes { 3 };
+
+    struct config_t {
+        std::size_t threads    {0}; // CPU workers, 0 -> hardware concurrency
+        std::size_t io_threads {8}; // reading is latency bound -> not tied to the number of cores
+        std::vector<int> cpus  {};  // worker i is pinned to cpus[i % size], empty -> not pinned
+    };
+
+    exec::config_t config_from_env();
+    bool parse_cpus(const std::string &list, std::vector<int> &cpus); // "0-3,6" -> 0 1 2 3 6
+    bool configure(const exec::config_t &c); // false if the pool runs already
+    std::size_t workers();
+    std::size_t io_threads();
+    exec::lane_t current_lane(); // lane of the job running on the calling thread (normal outside of jobs)
+
+    namespace detail
+    {
+        void post(exec::lane_t lane, std::function<void()> job);
+        void post_io(std::function<void()> job);
+        bool on_worker();
+        bool help_one(exec::lane_t lowest); // runs one pending job of the lane or higher, false if none
+    }
+
+    /**
+     * result of the job, waiting on a worker runs the other pending jobs of the lane of the job or higher
+     */
+    template<typename T>
+    class future_t {
+    public:
+        future_t() = default;
+        future_t(std::future<T> &&f, exec::lane_t lane) : f(std::move(f)), lane(lane) {}
+
+        bool valid() const { return f.valid(); }
+        bool ready() const { return f.wait_for(std::chrono::seconds(0)) == std::future_status::ready; }
+
+        void wait() const {
+            if (!detail::on_worker()) {
+                f.wait();
+                return;
+            }
+            while (!ready())
+                if (!detail::help_one(lane))
+                    f.wait_for(std::chrono::microseconds(100)); // the job runs on another worker
+        }
+        T get() {
+            wait();
+            return f.get();
+        }
+
+    private:
+        std::future<T> f;
+        exec::lane_t lane { exec::lane_t::NORMAL }; // of the job (I/O jobs: of the submitting job)
+    };
+
+    namespace detail
+    {
+        template<typename F, typename... Args>
+        auto package(exec::lane_t lane, F &&f, Args &&...args)
+        {
+            using R = std::invoke_result_t<std::decay_t<F>, std::decay_t<Args>...>;
+            auto task = std::make_shared<std::packaged_task<R()>>(
+                [f = std::forward<F>(f), args = std::make_tuple(std::forward<Args>(args)...)]() mutable {
+                    return std::apply(f, std::move(args));
+                });
+            return std::make_pair(exec::future_t<R>(task->get_future(), lane), [task]() { (*task)(); });
+        }
+    }
+
+    // like std::async(std::launch::async, f, args...) on the given lane
+    template<typename F, typename... Args>
+    auto async_on(exec::lane_t lane, F &&f, Args &&...args)
+    {
+        auto [fut, job] = detail::package(lane, std::forward<F>(f), std::forward<Args>(args)...);
+        detail::post(lane, std::move(job));
+        return std::move(fut);
+    }
+
+    // on the lane of the calling job
+    template<typename F, typename... Args>
+    auto async(F &&f, Args &&...args)
+    {
+        return exec::async_on(exec::current_lane(), std::forward<F>(f), std::forward<Args>(args)...);
+    }
+
+    // on the blocking I/O threads
+    template<typename F, typename... Args>
+    auto async_io(F &&f, Args &&...args)
+    {
+        auto [fut, job] = detail::package(exec::current_lane(), std::forward<F>(f), std::forward<Args>(args)...);
+        detail::post_io(std::move(job));
+        return std::move(fut);
+    }
+}
+
+#endif // EXEC_HPP
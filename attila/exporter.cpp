@@ -0,0 +1,329 @@
+#include <algorithm> // min, max
+#include <cstddef>   // size_t
+#include <cstdint>   // uint8_t, uint32_t, uint64_t, int64_t
+#include <deque>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>   // move
+#include <vector>
+
+#include <fmt/core.h>
+
+#include "exporter.hpp"
+#include "exec.hpp"     // shared thread pool
+#include "mem.hpp"     // heap accounting per stage
+#include "structs.hpp" // ss namespace with struct defs
+#include "topk.hpp"    // topk::group_t
+
+using format_t = exporter::format_t;
+
+namespace
+{
+    constexpr std::size_t chunk_rows { 4096 }; // rows formatted by one job & written at once
+
+    /**
+     * format rows [beg, end) by chunks in parallel & write them in order,
+     * at most `window` chunks are formatted/buffered at the same time.
+     */
+    template<typename F>
+    std::size_t stream_chunks(std::ostream &os, std::size_t nrows, F &&format_chunk)
+    {
+        const std::size_t window = exec::workers();
+        std::deque<exec::future_t<std::string>> inflight;
+        std::size_t next {0};
+        std::size_t written {0};
+        auto launch = [&]() {
+            const std::size_t beg = next;
+            const std::size_t end = std::min(beg + chunk_rows, nrows);
+            next = end;
+            inflight.push_back(exec::async([&format_chunk, beg, end]() {
+                const mem::scope_t mscope(mem::stage_t::EXPORT);
+                return format_chunk(beg, end);
+            }));
+        };
+        while (next < nrows && inflight.size() < window)
+            launch();
+        while (!inflight.empty()) {
+            const std::string buf = inflight.front().get();
+            inflight.pop_front();
+            if (next < nrows)
+                launch(); // keep the window full while writing
+            os.write(buf.data(), static_cast<std::streamsize>(buf.size()));
+            written += buf.size();
+        }
+        return written;
+    }
+
+    void csv_field(std::string &out, std::string_view s)
+    {
+        if (s.find_first_of(",\"\r\n") == std::string_view::npos) {
+            out += s;
+            return;
+        }
+        out += '"';
+        for (const char c : s) {
+            if (c == '"')
+                out += '"';
+            out += c;
+        }
+        out += '"';
+    }
+
+    void json_string(std::string &out, std::string_view s)
+    {
+        out += '"';
+        for (const char c : s) {
+            switch (c) {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n";  break;
+            case '\r': out += "\\r";  break;
+            case '\t': out += "\\t";  break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20)
+                    out += fmt::format("\\u{:04x}", static_cast<unsigned>(c));
+                else
+                    out += c;
+            }
+        }
+        out += '"';
+    }
+
+    void put_u32(std::string &out, std::uint32_t v)
+    {
+        for (int i = 0; i < 4; i++)
+            out += static_cast<char>((v >> (8 * i)) & 0xff);
+    }
+
+    void put_u64(std::string &out, std::uint64_t v)
+    {
+        for (int i = 0; i < 8; i++)
+            out += static_cast<char>((v >> (8 * i)) & 0xff);
+    }
+
+    void put_varint(std::string &out, std::uint64_t v)
+    {
+        while (v >= 0x80) {
+            out += static_cast<char>((v & 0x7f) | 0x80);
+            v >>= 7;
+        }
+        out += static_cast<char>(v);
+    }
+
+    std::uint64_t zigzag(std::int64_t v)
+    {
+        return (static_cast<std::uint64_t>(v) << 1) ^ static_cast<std::uint64_t>(v >> 63);
+    }
+
+    // string column: lengths first, then the bytes
+    struct strcol_t {
+        std::string lens;
+        std::string bytes;
+        void push(std::string_view s) {
+            put_varint(lens, s.size());
+            bytes += s;
+        }
+        std::string take() { return std::move(lens) + bytes; }
+    };
+
+    void put_block(std::string &out, std::uint32_t nrows, const std::vector<std::string> &columns)
+    {
+        put_u32(out, nrows);
+        for (const auto &c : columns) {
+            put_u64(out, c.size());
+            out += c;
+        }
+    }
+
+    std::size_t merged_count(const ss::task_t &t)
+    {
+        return std::max<std::size_t>(1, t.subt_t.size());
+    }
+
+    std::string task_csv(const ss::vtasks_t &vtt, std::size_t beg, std::size_t end)
+    {
+        std::string out;
+        out.reserve((end - beg) * 96);
+        for (std::size_t i = beg; i < end; i++) {
+            const ss::task_t &t = vtt[i];
+            const ss::hm_t &h = t.hm_t;
+            out += fmt::format("{},{},{},{},{},{},{},", h.date_fr, h.time_fr, h.date_to, h.time_to,
+                               h.diff, t.root, merged_count(t));
+            std::string projects;
+            for (std::size_t p = 0; p < t.tproj.size(); p++) {
+                if (p)
+                    projects += ';';
+                projects += t.tproj[p];
+            }
+            csv_field(out, projects);
+            out += ',';
+            csv_field(out, t.text);
+            out += '\n';
+        }
+        return out;
+    }
+
+    std::string task_ndjson(const ss::vtasks_t &vtt, std::size_t beg, std::size_t end)
+    {
+        std::string out;
+        out.reserve((end - beg) * 192);
+        for (std::size_t i = beg; i < end; i++) {
+            const ss::task_t &t = vtt[i];
+            const ss::hm_t &h = t.hm_t;
+            out += fmt::format(R"({{"date_fr":"{}","time_fr":"{}","date_to":"{}","time_to":"{}","sec":{},"root":{},"merged":{},"projects":[)",
+                               h.date_fr, h.time_fr, h.date_to, h.time_to, h.diff, t.root, merged_count(t));
+            for (std::size_t p = 0; p < t.tproj.size(); p++) {
+                if (p)
+                    out += ',';
+                json_string(out, t.tproj[p]);
+            }
+            out += R"(],"text":)";
+            json_string(out, t.text);
+            out += "}\n";
+        }
+        return out;
+    }
+
+    std::string task_col(const ss::vtasks_t &vtt, std::size_t beg, std::size_t end)
+    {
+        std::string begs, secs, roots, merged;
+        strcol_t projects, texts;
+        std::int64_t prev {0};
+        for (std::size_t i = beg; i < end; i++) {
+            const ss::task_t &t = vtt[i];
+            const std::int64_t b = t.hm_t.beg;
+            put_varint(begs, zigzag(b - prev));
+            prev = b;
+            put_varint(secs, static_cast<std::uint64_t>(std::max<std::int64_t>(t.hm_t.diff, 0)));
+            put_varint(roots, t.root);
+            put_varint(merged, merged_count(t));
+            std::string p;
+            for (std::size_t j = 0; j < t.tproj.size(); j++) {
+                if (j)
+                    p += '\x1f';
+                p += t.tproj[j];
+            }
+            projects.push(p);
+            texts.push(t.text);
+        }
+        std::string out;
+        put_block(out, static_cast<std::uint32_t>(end - beg),
+                  { begs, secs, roots, merged, projects.take(), texts.take() });
+        return out;
+    }
+
+    std::string group_csv(const std::vector<topk::group_t> &groups, std::size_t beg, std::size_t end)
+    {
+        std::string out;
+        for (std::size_t i = beg; i < end; i++) {
+            csv_field(out, groups[i].key);
+            out += fmt::format(",{},{}\n", groups[i].sec, groups[i].count);
+        }
+        return out;
+    }
+
+    std::string group_ndjson(const std::vector<topk::group_t> &groups, std::size_t beg, std::size_t end)
+    {
+        std::string out;
+        for (std::size_t i = beg; i < end; i++) {
+            out += R"({"key":)";
+            json_string(out, groups[i].key);
+            out += fmt::format(R"(,"sec":{},"count":{}}})", groups[i].sec, groups[i].count);
+            out += '\n';
+        }
+        return out;
+    }
+
+    std::string group_col(const std::vector<topk::group_t> &groups, std::size_t beg, std::size_t end)
+    {
+        std::string secs, counts;
+        strcol_t keys;
+        for (std::size_t i = beg; i < end; i++) {
+            put_varint(secs, groups[i].sec);
+            put_varint(counts, groups[i].count);
+            keys.push(groups[i].key);
+        }
+        std::string out;
+        put_block(out, static_cast<std::uint32_t>(end - beg), { secs, counts, keys.take() });
+        return out;
+    }
+
+    std::size_t write_raw(std::ostream &os, std::string_view s)
+    {
+        os.write(s.data(), static_cast<std::streamsize>(s.size()));
+        return s.size();
+    }
+
+    std::size_t write_end(std::ostream &os, format_t f)
+    {
+        if (f != format_t::COL)
+            return 0;
+        std::string out;
+        put_u32(out, 0); // empty block -> end of the stream
+        return write_raw(os, out);
+    }
+}
+
+bool exporter::format_of(const std::string &name, exporter::format_t &f)
+{
+    if (name == "csv")
+        f = format_t::CSV;
+    else if (name == "ndjson" || name == "json")
+        f = format_t::NDJSON;
+    else if (name == "col" || name == "columnar")
+        f = format_t::COL;
+    else
+        return false;
+    return true;
+}
+
+/**
+ * write tasks (parsed or merged) in the format, returns number of written bytes
+ */
+std::size_t exporter::write_tasks(std::ostream &os, const ss::vtasks_t &vtt, exporter::format_t f)
+{
+    const mem::scope_t mscope(mem::stage_t::EXPORT);
+    std::size_t written {0};
+    switch (f) {
+    case format_t::CSV:
+        written += write_raw(os, "date_fr,time_fr,date_to,time_to,sec,root,merged,projects,text\n");
+        written += stream_chunks(os, vtt.size(), [&](std::size_t b, std::size_t e) { return task_csv(vtt, b, e); });
+        break;
+    case format_t::NDJSON:
+        written += stream_chunks(os, vtt.size(), [&](std::size_t b, std::size_t e) { return task_ndjson(vtt, b, e); });
+        break;
+    case format_t::COL:
+        written += write_raw(os, "ATCOLT01");
+        written += stream_chunks(os, vtt.size(), [&](std::size_t b, std::size_t e) { return task_col(vtt, b, e); });
+        break;
+    }
+    written += write_end(os, f);
+    os.flush();
+    return written;
+}
+
+/**
+ * write group aggregates (key, time spent, tasks count), returns number of written bytes
+ */
+std::size_t exporter::write_groups(std::ostream &os, const std::vector<topk::group_t> &groups, exporter::format_t f)
+{
+    const mem::scope_t mscope(mem::stage_t::EXPORT);
+    std::size_t written {0};
+    switch (f) {
+    case format_t::CSV:
+        written += write_raw(os, "key,sec,count\n");
+        written += stream_chunks(os, groups.size(), [&](std::size_t b, std::size_t e) { return group_csv(groups, b, e); });
+        break;
+    case format_t::NDJSON:
+        written += stream_chunks(os, groups.size(), [&](std::size_t b, std::size_t e) { return group_ndjson(groups, b, e); });
+        break;
+    case format_t::COL:
+        written += write_raw(os, "ATCOLG01");
+        written += stream_chunks(os, groups.size(), [&](std::size_t b, std::size_t e) { return group_col(groups, b, e); });
+        break;
+    }
+    written += write_end(os, f);
+    os.flush();
+    return written;
+}
@@ -0,0 +1,37 @@
+#ifndef EXPORTER_HPP
+#define EXPORTER_HPP
+
+#include <cstddef> // size_t
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "structs.hpp" // ss namespace with struct defs
+#include "topk.hpp"    // topk::group_t
+
+namespace exporter
+{
+    /**
+     * streaming export of the tasks & group aggregates.
+     * rows are formatted by chunks in parallel & written in order by the buffered chunk writes,
+     * only a bounded window of the chunks is in flight -> memory does not depend on the row count.
+     *
+     * CSV    -> RFC 4180 with the header line
+     * NDJSON -> one JSON object per line
+     * COL    -> compact columnar binary:
+     *   magic "ATCOLT01" (tasks) / "ATCOLG01" (groups), then blocks:
+     *   u32 nrows, per column: u64 nbytes + column bytes (all little endian), nrows == 0 ends the stream.
+     *   integer columns are LEB128 varints (task beginnings are zigzag deltas within the block),
+     *   string columns are varint lengths followed by the concatenated bytes.
+     *   tasks columns:  beg, sec, root, merged, projects ('\x1f' separated), text
+     *   groups columns: sec, count, key
+     */
+    enum class format_t { CSV, NDJSON, COL };
+
+    bool format_of(const std::string &name, exporter::format_t &f);
+
+    std::size_t write_tasks(std::ostream &os, const ss::vtasks_t &vtt, exporter::format_t f);
+    std::size_t write_groups(std::ostream &os, const std::vector<topk::group_t> &groups, exporter::format_t f);
+}
+
+#endif // EXPORTER_HPP
@@ -0,0 +1,158 @@
+#include <algorithm> // min, max, sort
+#include <cctype>    // isalnum
+#include <cstddef>   // size_t
+#include <functional>
+#include <queue>     // priority_queue
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "fuzzy.hpp"
+#include "exec.hpp"    // shared thread pool
+#include "structs.hpp" // ss namespace with struct defs
+#include "str.hpp"     // str namespace
+
+namespace
+{
+    // score weights
+    constexpr int sc_match       { 16 };
+    constexpr int sc_word_start  { 10 }; // first character of the word
+    constexpr int sc_consecutive {  8 }; // per already matched character in a row
+    constexpr int sc_exact_case  {  1 };
+    constexpr int sc_gap_start   { -3 };
+    constexpr int sc_gap_extend  { -1 };
+    constexpr int sc_max_offset  { 15 }; // max penalty for the match far from the beginning
+
+    inline char lower(char c)
+    {
+        return (c >= 'A' && c <= 'Z') ? static_cast<char>(c + ('a' - 'A')) : c;
+    }
+
+    inline bool word_start(std::string_view t, std::size_t i)
+    {
+        return i == 0 || !std::isalnum(static_cast<unsigned char>(t[i - 1]));
+    }
+
+    // better hit first: higher score, then earlier task
+    inline bool better(const fuzzy::hit_t &a, const fuzzy::hit_t &b)
+    {
+        return a.score > b.score || (a.score == b.score && a.index < b.index);
+    }
+}
+
+/**
+ * split query on the whitespace separated terms (all of them must match)
+ */
+std::vector<std::string> fuzzy::terms(const std::string &query)
+{
+    return str::resplit(query, std::regex{"\\s+"});
+}
+
+/**
+ * subsequence score of the term in the text (case insensitive), -1 if not matched.
+ * the tightest window of the first occurrence is scored:
+ * forward scan finds the end of the occurrence, backward scan shrinks its beginning.
+ */
+int fuzzy::score(std::string_view q, std::string_view t)
+{
+    if (q.empty())
+        return 0;
+    std::size_t qi {0};
+    std::size_t end {0};
+    for (std::size_t i = 0; i < t.size(); i++) {
+        if (lower(t[i]) == lower(q[qi]) && ++qi == q.size()) {
+            end = i + 1;
+            break;
+        }
+    }
+    if (qi < q.size())
+        return -1; // not a subsequence
+    std::size_t beg = end;
+    for (qi = q.size(); qi > 0; ) {
+        --beg;
+        if (lower(t[beg]) == lower(q[qi - 1]))
+            --qi;
+    }
+    int sc {0};
+    int run {0}; // matched characters in a row
+    qi = 0;
+    for (std::size_t i = beg; i < end && qi < q.size(); i++) {
+        if (lower(t[i]) == lower(q[qi])) {
+            sc += sc_match + sc_consecutive * std::min(run, 4);
+            if (word_start(t, i))
+                sc += sc_word_start;
+            if (t[i] == q[qi])
+                sc += sc_exact_case;
+            ++run;
+            ++qi;
+        } else {
+            sc += (run) ? sc_gap_start : sc_gap_extend;
+            run = 0;
+        }
+    }
+    sc -= static_cast<int>(std::min<std::size_t>(beg, sc_max_offset));
+    return std::max(sc, 0);
+}
+
+int fuzzy::score(const std::vector<std::string> &terms, std::string_view text)
+{
+    int sc {0};
+    for (const auto &term : terms) {
+        const int tsc = fuzzy::score(term, text);
+        if (tsc < 0)
+            return -1;
+        sc += tsc;
+    }
+    return sc;
+}
+
+/**
+ * score every task against the query in parallel & return k best hits ranked by score.
+ * each chunk keeps only its k best hits in the bounded min-heap,
+ * set cancellation token stops the chunks (checked once per 4096 tasks).
+ */
+std::vector<fuzzy::hit_t> fuzzy::top_k(const ss::vtasks_t &vtt, const std::string &query, std::size_t k,
+                                       const std::atomic<bool> *cancel)
+{
+    const std::vector<std::string> qterms = fuzzy::terms(query);
+    if (qterms.empty() || vtt.empty() || k == 0)
+        return {};
+    auto worse = [](const fuzzy::hit_t &a, const fuzzy::hit_t &b) { return better(a, b); };
+    using heap_t = std::priority_queue<fuzzy::hit_t, std::vector<fuzzy::hit_t>, decltype(worse)>;
+    auto score_chunk = [&](std::size_t beg, std::size_t end) -> std::vector<fuzzy::hit_t> {
+        heap_t heap(worse); // top() is the worst of the kept hits
+        for (std::size_t i = beg; i < end; i++) {
+            if (cancel && ((i - beg) & 0xfff) == 0 && cancel->load(std::memory_order_relaxed))
+                break; // NOTE: partial hits -> caller drops them
+            const int sc = fuzzy::score(qterms, vtt[i].text);
+            if (sc < 0)
+                continue;
+            const fuzzy::hit_t hit { sc, i };
+            if (heap.size() < k) {
+                heap.push(hit);
+            } else if (better(hit, heap.top())) {
+                heap.pop();
+                heap.push(hit);
+            }
+        }
+        std::vector<fuzzy::hit_t> hits;
+        hits.reserve(heap.size());
+        for (; !heap.empty(); heap.pop())
+            hits.push_back(heap.top());
+        return hits;
+    };
+    const std::size_t nchunks = exec::workers();
+    const std::size_t chunk = (vtt.size() + nchunks - 1) / nchunks;
+    std::vector<exec::future_t<std::vector<fuzzy::hit_t>>> futures;
+    for (std::size_t beg = 0; beg < vtt.size(); beg += chunk)
+        futures.push_back(exec::async(score_chunk, beg, std::min(beg + chunk, vtt.size())));
+    std::vector<fuzzy::hit_t> hits;
+    for (auto &f : futures) {
+        std::vector<fuzzy::hit_t> tmp_vec = f.get();
+        hits.insert(hits.end(), tmp_vec.begin(), tmp_vec.end());
+    }
+    const std::size_t n = std::min(k, hits.size());
+    std::partial_sort(hits.begin(), hits.begin() + n, hits.end(), better);
+    hits.resize(n);
+    return hits;
+}
@@ -0,0 +1,28 @@
+#ifndef FUZZY_HPP
+#define FUZZY_HPP
+
+#include <atomic>  // atomic<bool> cancellation token
+#include <cstddef> // size_t
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "structs.hpp" // ss namespace with struct defs
+
+namespace fuzzy
+{
+    struct hit_t {
+        int score;
+        std::size_t index; // index of the task in the scored vector
+    };
+
+    std::vector<std::string> terms(const std::string &query);
+
+    int score(std::string_view term, std::string_view text);
+    int score(const std::vector<std::string> &terms, std::string_view text);
+
+    std::vector<fuzzy::hit_t> top_k(const ss::vtasks_t &vtt, const std::string &query, std::size_t k,
+                                    const std::atomic<bool> *cancel = nullptr);
+}
+
+#endif // FUZZY_HPP
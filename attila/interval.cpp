@@ -0,0 +1,303 @@
+#include <algorithm> // sort, max, min, partition_point
+#include <cstddef>   // size_t
+#include <cstdint>   // int64_t, uint32_t
+#include <ctime>     // time_t, tm, mktime, localtime_r
+#include <string>
+#include <vector>
+
+#include <fmt/core.h>
+
+#include "interval.hpp"
+#include "cal.hpp"     // ISO week calendar
+#include "exec.hpp"    // shared thread pool
+#include "mem.hpp"     // heap accounting per stage
+
+namespace
+{
+    int day_of(std::time_t t)
+    {
+        std::tm tm {};
+        localtime_r(&t, &tm);
+        return cal::days_of(cal::date_t { tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday });
+    }
+
+    std::time_t midnight(int days)
+    {
+        const cal::date_t d = cal::date_of(days);
+        std::tm tm {};
+        tm.tm_year  = d.year - 1900;
+        tm.tm_mon   = d.month - 1;
+        tm.tm_mday  = d.day;
+        tm.tm_isdst = -1; // NOTE: days of the DST change are 23 or 25 hours long
+        return std::mktime(&tm);
+    }
+
+    std::string hm(std::time_t sec)
+    {
+        return fmt::format("{:02}:{:02}", sec / 3600, sec % 3600 / 60);
+    }
+
+    std::string stamp(std::time_t t)
+    {
+        std::tm tm {};
+        localtime_r(&t, &tm);
+        return fmt::format("{:04}-{:02}-{:02} {:02}:{:02}",
+                           tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday, tm.tm_hour, tm.tm_min);
+    }
+
+    constexpr const char *wdays[] { "Mon", "Tue", "Wed", "Thu", "Fri", "Sat", "Sun" };
+}
+
+/**
+ * sort by the beginning & compute the max end of each subtree (level 0: even positions are the leaves),
+ * nodes of the incomplete right edge take the max end of the last subtree
+ */
+void interval::tree_t::build(std::vector<interval::iv_t> ivs)
+{
+    std::sort(ivs.begin(), ivs.end(), [](const iv_t &x, const iv_t &y) {
+        return x.beg < y.beg || (x.beg == y.beg && x.end < y.end);
+    });
+    a = std::move(ivs);
+    const std::int64_t n = static_cast<std::int64_t>(a.size());
+    max_end.assign(a.size(), 0);
+    levels = -1;
+    if (n == 0)
+        return;
+    std::int64_t last_i {0};
+    std::time_t  last {0};
+    for (std::int64_t i = 0; i < n; i += 2) {
+        last_i = i;
+        last = max_end[i] = a[i].end;
+    }
+    int k = 1;
+    for (; (std::int64_t {1} << k) <= n; k++) {
+        const std::int64_t x = std::int64_t {1} << (k - 1), i0 = (x << 1) - 1, step = x << 2;
+        for (std::int64_t i = i0; i < n; i += step) {
+            const std::time_t el = max_end[i - x];
+            const std::time_t er = (i + x < n) ? max_end[i + x] : last;
+            max_end[i] = std::max({ a[i].end, el, er });
+        }
+        last_i = ((last_i >> k) & 1) ? last_i - x : last_i + x;
+        if (last_i < n && max_end[last_i] > last)
+            last = max_end[last_i];
+    }
+    levels = k - 1;
+}
+
+/**
+ * positions of the intervals intersecting [beg, end): left subtrees ending before beg
+ * & right subtrees beginning at/after end are not visited, small subtrees are scanned
+ */
+void interval::tree_t::query(std::time_t beg, std::time_t end, std::vector<std::size_t> &out) const
+{
+    struct node_t {
+        int k;          // level
+        std::int64_t x; // position
+        bool left_done;
+    };
+    if (levels < 0 || beg >= end)
+        return;
+    const std::int64_t n = static_cast<std::int64_t>(a.size());
+    node_t stack[64];
+    int t {0};
+    stack[t++] = { levels, (std::int64_t {1} << levels) - 1, false };
+    while (t) {
+        const node_t z = stack[--t];
+        if (z.k <= 3) {
+            const std::int64_t i0 = z.x >> z.k << z.k;
+            const std::int64_t i1 = std::min(i0 + (std::int64_t {1} << (z.k + 1)) - 1, n);
+            for (std::int64_t i = i0; i < i1 && a[i].beg < end; i++)
+                if (beg < a[i].end)
+                    out.push_back(static_cast<std::size_t>(i));
+        } else if (!z.left_done) {
+            const std::int64_t y = z.x - (std::int64_t {1} << (z.k - 1));
+            stack[t++] = { z.k, z.x, true };
+            if (y >= n || max_end[y] > beg)
+                stack[t++] = { z.k - 1, y, false };
+        } else if (z.x < n && a[z.x].beg < end) {
+            if (beg < a[z.x].end)
+                out.push_back(static_cast<std::size_t>(z.x));
+            stack[t++] = { z.k - 1, z.x + (std::int64_t {1} << (z.k - 1)), false };
+        }
+    }
+}
+
+/**
+ * the tree of the tasks & the sweep for the double-booked pairs run in parallel with the union & gaps
+ */
+interval::index_t::index_t(const ss::vtasks_t &vtt)
+{
+    const mem::scope_t mscope(mem::stage_t::ANALYZE);
+    std::vector<iv_t> ivs;
+    ivs.reserve(vtt.size());
+    for (std::size_t i = 0; i < vtt.size(); i++) {
+        const std::time_t beg = vtt[i].hm_t.beg, diff = vtt[i].hm_t.diff;
+        if (diff > 0)
+            ivs.push_back({ beg, beg + diff, static_cast<std::uint32_t>(i) });
+    }
+    tasks.build(std::move(ivs));
+    const std::vector<iv_t> &a = tasks.items();
+
+    auto segments = exec::async([this, &a] {
+        for (const iv_t &x : a) {
+            if (!segs.empty() && x.beg <= segs.back().end)
+                segs.back().end = std::max(segs.back().end, x.end);
+            else
+                segs.push_back({ x.beg, x.end, 0 });
+        }
+        covered_before.assign(segs.size() + 1, 0);
+        for (std::size_t i = 0; i < segs.size(); i++)
+            covered_before[i + 1] = covered_before[i] + (segs[i].end - segs[i].beg);
+        for (std::size_t i = 0; i + 1 < segs.size(); i++)
+            if (day_of(segs[i].end - 1) == day_of(segs[i + 1].beg))
+                idle.push_back({ segs[i].end, segs[i + 1].beg, 0 });
+        idle_leaves = 1;
+        while (idle_leaves < idle.size())
+            idle_leaves <<= 1;
+        idle_max.assign(2 * idle_leaves, 0);
+        for (std::size_t i = 0; i < idle.size(); i++)
+            idle_max[idle_leaves + i] = idle[i].end - idle[i].beg;
+        for (std::size_t i = idle_leaves - 1; i > 0; i--)
+            idle_max[i] = std::max(idle_max[2 * i], idle_max[2 * i + 1]);
+    });
+
+    // active: earlier tasks which have not ended yet -> each of them overlaps the next task
+    std::vector<iv_t> common;
+    std::vector<std::size_t> active;
+    for (std::size_t i = 0; i < a.size(); i++) {
+        std::size_t w {0};
+        for (const std::size_t j : active) {
+            if (a[j].end <= a[i].beg)
+                continue;
+            active[w++] = j;
+            common.push_back({ a[i].beg, std::min(a[i].end, a[j].end), static_cast<std::uint32_t>(pairs.size()) });
+            pairs.emplace_back(a[j].id, a[i].id);
+        }
+        active.resize(w);
+        active.push_back(i);
+    }
+    doubles.build(std::move(common));
+    segments.get();
+}
+
+std::vector<std::uint32_t> interval::index_t::overlapping(std::time_t beg, std::time_t end) const
+{
+    std::vector<std::size_t> pos;
+    tasks.query(beg, end, pos);
+    std::vector<std::uint32_t> ids;
+    ids.reserve(pos.size());
+    for (const std::size_t p : pos)
+        ids.push_back(tasks.items()[p].id);
+    return ids;
+}
+
+std::vector<interval::overlap_t> interval::index_t::overlaps(std::time_t beg, std::time_t end) const
+{
+    std::vector<std::size_t> pos;
+    doubles.query(beg, end, pos);
+    std::sort(pos.begin(), pos.end()); // NOTE: positions are sorted by the beginning
+    std::vector<overlap_t> out;
+    out.reserve(pos.size());
+    for (const std::size_t p : pos) {
+        const iv_t &c = doubles.items()[p];
+        out.push_back({ c.beg, c.end, pairs[c.id].first, pairs[c.id].second });
+    }
+    return out;
+}
+
+/**
+ * idle gaps intersecting [beg, end) which are at least min_sec long:
+ * subtrees of the max tree with shorter gaps only are not visited
+ */
+std::vector<interval::iv_t> interval::index_t::gaps(std::time_t beg, std::time_t end, std::time_t min_sec) const
+{
+    std::vector<iv_t> out;
+    const std::size_t l = std::partition_point(idle.begin(), idle.end(), [beg](const iv_t &g) {
+        return g.end <= beg;
+    }) - idle.begin();
+    const std::size_t r = std::partition_point(idle.begin(), idle.end(), [end](const iv_t &g) {
+        return g.beg < end;
+    }) - idle.begin();
+    if (l >= r)
+        return out;
+    auto report = [&](auto &self, std::size_t node, std::size_t lo, std::size_t hi) -> void {
+        if (hi <= l || r <= lo || idle_max[node] < min_sec)
+            return;
+        if (hi - lo == 1) {
+            out.push_back(idle[lo]);
+            return;
+        }
+        const std::size_t mid = lo + (hi - lo) / 2;
+        self(self, 2 * node, lo, mid);
+        self(self, 2 * node + 1, mid, hi);
+    };
+    report(report, 1, 0, idle_leaves);
+    return out;
+}
+
+std::time_t interval::index_t::covered(std::time_t beg, std::time_t end) const
+{
+    if (beg >= end)
+        return 0;
+    const std::size_t l = std::partition_point(segs.begin(), segs.end(), [beg](const iv_t &s) {
+        return s.end <= beg;
+    }) - segs.begin();
+    const std::size_t r = std::partition_point(segs.begin(), segs.end(), [end](const iv_t &s) {
+        return s.beg < end;
+    }) - segs.begin();
+    if (l >= r)
+        return 0;
+    std::time_t sum = covered_before[r] - covered_before[l];
+    sum -= std::max<std::time_t>(beg - segs[l].beg, 0);       // clipped by the span
+    sum -= std::max<std::time_t>(segs[r - 1].end - end, 0);
+    return sum;
+}
+
+interval::day_t interval::index_t::day(int days) const
+{
+    day_t d;
+    d.days = days;
+    const std::time_t m0 = midnight(days), m1 = midnight(days + 1);
+    const std::size_t l = std::partition_point(segs.begin(), segs.end(), [m0](const iv_t &s) {
+        return s.end <= m0;
+    }) - segs.begin();
+    const std::size_t r = std::partition_point(segs.begin(), segs.end(), [m1](const iv_t &s) {
+        return s.beg < m1;
+    }) - segs.begin();
+    if (l >= r)
+        return d;
+    d.first = std::max(segs[l].beg, m0);
+    d.last  = std::min(segs[r - 1].end, m1);
+    d.busy  = covered(m0, m1);
+    return d;
+}
+
+std::string interval::report(const interval::index_t &ix, const ss::vtasks_t &vtt, std::time_t idle_min_sec)
+{
+    if (ix.empty())
+        return "no tasks with time spent\n";
+    const std::time_t fr = ix.first(), to = ix.last();
+
+    const std::vector<overlap_t> ov = ix.overlaps(fr, to);
+    std::string out { fmt::format("double-booked tasks: {}\n", ov.size()) };
+    for (const overlap_t &o : ov) {
+        out += fmt::format("  {}  {} {}\n", hm(o.end - o.beg), vtt[o.a].dts, vtt[o.a].text);
+        out += fmt::format("         {} {}\n", vtt[o.b].dts, vtt[o.b].text);
+    }
+
+    const std::vector<iv_t> gs = ix.gaps(fr, to, idle_min_sec);
+    out += fmt::format("\nidle gaps of {} at least: {}\n", hm(idle_min_sec), gs.size());
+    for (const iv_t &g : gs)
+        out += fmt::format("  {}  {} -> {}\n", hm(g.end - g.beg), stamp(g.beg), stamp(g.end).substr(11));
+
+    out += "\nutilization per day (busy / from the first to the last task):\n";
+    for (int d = day_of(fr), last = day_of(to - 1); d <= last; d++) {
+        const day_t u = ix.day(d);
+        if (!u.busy)
+            continue;
+        out += fmt::format("  {} {}  busy {}  active {}  {:>3.0f}%  idle {}\n",
+                           cal::date_str(cal::date_of(d)), wdays[cal::weekday(d) - 1], hm(u.busy),
+                           hm(u.active()), 100.0 * u.utilization(), hm(u.active() - u.busy));
+    }
+    return out;
+}
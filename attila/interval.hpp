@@ -0,0 +1,95 @@
+#ifndef INTERVAL_HPP
+#define INTERVAL_HPP
+
+#include <cstddef> // size_t
+#include <cstdint> // uint32_t
+#include <ctime>   // time_t
+#include <string>
+#include <utility> // pair
+#include <vector>
+
+#include "structs.hpp" // ss namespace with struct defs
+
+namespace interval
+{
+    /**
+     * tasks as time intervals [beg, end) (tasks without time spent are left out):
+     *   - implicit augmented interval tree (array sorted by the beginning, max end per subtree)
+     *     -> tasks intersecting a time span & double-booked tasks in O(log n + k),
+     *   - union of the tasks (sorted disjoint segments with prefix sums)
+     *     -> covered time of a time span & utilization of a day in O(log n),
+     *   - idle gaps between the segments of the same day with a max tree over their lengths
+     *     -> gaps longer than N in a time span in O(log n + k log n).
+     * double-booked pairs are found by one sweep over the sorted tasks (only the overlapping pairs are visited).
+     */
+    struct iv_t {
+        std::time_t beg {0};
+        std::time_t end {0};
+        std::uint32_t id {0}; // index of the task (of the pair for the double-booked parts)
+    };
+
+    struct overlap_t {
+        std::time_t beg {0}; // common part of the tasks
+        std::time_t end {0};
+        std::uint32_t a {0}; // tasks (a begins first)
+        std::uint32_t b {0};
+    };
+
+    struct day_t {
+        int days {0};         // day number (see cal.hpp)
+        std::time_t busy {0}; // covered by the tasks
+        std::time_t first {0}; // beginning of the first task & end of the last task of the day
+        std::time_t last {0};
+        std::time_t active() const { return last - first; }
+        double utilization() const { return (active() > 0) ? double(busy) / double(active()) : 0.0; }
+    };
+
+    /**
+     * implicit interval tree: node i of the level k has its children at i -+ 2^(k-1)
+     */
+    class tree_t {
+    public:
+        void build(std::vector<interval::iv_t> ivs);
+        void query(std::time_t beg, std::time_t end, std::vector<std::size_t> &out) const; // positions
+        const std::vector<interval::iv_t> &items() const { return a; }
+
+    private:
+        std::vector<interval::iv_t> a {};
+        std::vector<std::time_t> max_end {};
+        int levels {-1};
+    };
+
+    class index_t {
+    public:
+        index_t() = default;
+        explicit index_t(const ss::vtasks_t &vtt);
+
+        std::size_t size() const { return tasks.items().size(); }
+        bool empty() const { return segs.empty(); }
+        std::time_t first() const { return (segs.empty()) ? 0 : segs.front().beg; }
+        std::time_t last() const { return (segs.empty()) ? 0 : segs.back().end; }
+
+        std::vector<std::uint32_t> overlapping(std::time_t beg, std::time_t end) const; // tasks
+        std::vector<interval::overlap_t> overlaps(std::time_t beg, std::time_t end) const; // double-booked
+        std::vector<interval::iv_t> gaps(std::time_t beg, std::time_t end, std::time_t min_sec) const;
+        std::time_t covered(std::time_t beg, std::time_t end) const;
+        interval::day_t day(int days) const;
+
+    private:
+        interval::tree_t tasks {};
+        interval::tree_t doubles {}; // common parts of the double-booked pairs
+        std::vector<std::pair<std::uint32_t, std::uint32_t>> pairs {};
+        std::vector<interval::iv_t> segs {};  // union of the tasks
+        std::vector<std::time_t> covered_before {}; // prefix sums of the segments
+        std::vector<interval::iv_t> idle {};  // gaps between the segments within a day
+        std::vector<std::time_t> idle_max {}; // max tree over the lengths of the gaps
+        std::size_t idle_leaves {0};
+    };
+
+    /**
+     * double-booked tasks, idle gaps (>= idle_min_sec) & utilization per day of the indexed tasks
+     */
+    std::string report(const interval::index_t &ix, const ss::vtasks_t &vtt, std::time_t idle_min_sec);
+}
+
+#endif // INTERVAL_HPP
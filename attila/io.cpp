@@ -0,0 +1,55 @@
+#include <algorithm> // min
+#include <atomic>
+#include <cstddef>   // size_t
+#include <future>    // promise
+#include <memory>    // shared_ptr
+#include <string>
+#include <vector>
+
+#include "io.hpp"
+#include "exec.hpp"  // shared thread pool
+#include "str.hpp"   // str namespace
+#include "mem.hpp"   // heap accounting per stage
+
+/**
+ * number of concurrent readers for the files of the span.
+ * reading is latency bound (cold cache, network mounted dirs),
+ * therefore it is not tied to the number of cores, only bounded by the I/O threads of the pool.
+ */
+std::size_t io::io_workers(std::size_t nfiles)
+{
+    return std::max<std::size_t>(1, std::min(nfiles, exec::io_threads()));
+}
+
+/**
+ * read files concurrently by the readers on the I/O threads of the pool,
+ * each file is pushed into the channel as soon as it was read (in the order of arrival).
+ * the channel is closed (& the future is ready) after the last reader finished.
+ */
+std::future<void> io::read_files_async(const std::vector<std::string> &fpaths,
+                                       io::chan_t<io::fchunk_t> &ch)
+{
+    struct state_t {
+        std::vector<std::string> fpaths;
+        std::atomic<std::size_t> next { 0 };
+        std::atomic<std::size_t> readers;
+        std::promise<void> done;
+    };
+    const std::size_t nworkers = io::io_workers(fpaths.size());
+    auto st = std::make_shared<state_t>();
+    st->fpaths = fpaths;
+    st->readers = nworkers;
+    std::future<void> reading = st->done.get_future();
+    for (std::size_t w = 0; w < nworkers; w++) {
+        exec::async_io([st, &ch]() {
+            const mem::scope_t mscope(mem::stage_t::LOAD);
+            for (std::size_t i = st->next++; i < st->fpaths.size(); i = st->next++)
+                ch.push({ i, st->fpaths[i], str::file_content(st->fpaths[i]) });
+            if (--st->readers == 0) { // the last reader
+                ch.close();
+                st->done.set_value();
+            }
+        });
+    }
+    return reading;
+}
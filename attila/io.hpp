@@ -0,0 +1,73 @@
+#ifndef IO_HPP
+#define IO_HPP
+
+#include <condition_variable>
+#include <cstddef> // size_t
+#include <deque>
+#include <future>  // future
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace io
+{
+    /**
+     * bounded blocking queue (multiple producers & consumers)
+     * push() blocks while the queue is full, pop() blocks while it is empty.
+     * pop() returns std::nullopt once the queue is closed & drained.
+     */
+    template<typename T>
+    class chan_t {
+    public:
+        explicit chan_t(std::size_t cap) : cap(cap ? cap : 1) {}
+
+        void push(T v) {
+            std::unique_lock<std::mutex> lk(mtx);
+            cv_push.wait(lk, [&]{ return q.size() < cap || closed; });
+            if (closed)
+                return; // nobody will consume it anyway
+            q.push_back(std::move(v));
+            cv_pop.notify_one();
+        }
+
+        std::optional<T> pop() {
+            std::unique_lock<std::mutex> lk(mtx);
+            cv_pop.wait(lk, [&]{ return !q.empty() || closed; });
+            if (q.empty())
+                return std::nullopt; // closed & drained
+            T v = std::move(q.front());
+            q.pop_front();
+            cv_push.notify_one();
+            return v;
+        }
+
+        void close() {
+            std::lock_guard<std::mutex> lk(mtx);
+            closed = true;
+            cv_push.notify_all();
+            cv_pop.notify_all();
+        }
+
+    private:
+        std::mutex mtx;
+        std::condition_variable cv_push;
+        std::condition_variable cv_pop;
+        std::deque<T> q;
+        const std::size_t cap;
+        bool closed { false };
+    };
+
+    struct fchunk_t {
+        std::size_t index; // position of the file in the requested file list
+        std::string fpath;
+        std::string content;
+    };
+
+    std::size_t io_workers(std::size_t nfiles);
+
+    std::future<void> read_files_async(const std::vector<std::string> &fpaths,
+                                       io::chan_t<io::fchunk_t> &ch);
+}
+
+#endif // IO_HPP
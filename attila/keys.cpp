@@ -24,6 +24,15 @@ void Keys::scroll()
     case 1:
         sobj = ui->spentText;
         break;
+    case 2:
+        sobj = ui->heatmapText;
+        break;
+    case 3:
+        sobj = ui->topText;
+        break;
+    case 4:
+        sobj = ui->intervalText;
+        break;
     default:
         qDebug() << "Tab without scroll shortcut! index:"
                  << ui->tabWidget->currentIndex();
@@ -140,10 +149,19 @@ void Keys::hotkeys()
 
     sact(tr("Ctrl+1"), &Action::goto_tab1);
     sact(tr("Ctrl+2"), &Action::goto_tab2);
+    sact(tr("Ctrl+3"), &Action::goto_tab3);
+    sact(tr("Ctrl+4"), &Action::goto_tab4);
+    sact(tr("Ctrl+5"), &Action::goto_tab5);
     sact(tr("Ctrl+t"), &Action::goto_text);
     sact(tr("Ctrl+f"), &Action::goto_filter);
+    sact(tr("Ctrl+r"), &Action::cycle_filter_mode);
     sact(tr("Ctrl+d"),       &Action::goto_date_fr);
     sact(tr("Ctrl+Shift+D"), &Action::goto_date_to);
-    sact(tr("Ctrl+m"), &Action::toggle_merge);
+    sact(tr("Ctrl+m"),       &Action::toggle_merge);
+    sact(tr("Ctrl+Shift+M"), &Action::toggle_near);
+    sact(tr("Ctrl+o"),       &Action::cycle_sort);
+    sact(tr("Ctrl+Shift+O"), &Action::toggle_sort_order);
+    sact(tr("Ctrl+l"), &Action::toggle_live);
+    sact(tr("F12"),    &Action::toggle_mem);
 }
 
@@ -0,0 +1,120 @@
+#include <cstddef>   // size_t
+#include <cstring>   // memchr
+#include <string_view>
+#include <vector>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define LINES_X86 1
+#include <immintrin.h>
+#endif
+
+#include "lines.hpp"
+
+/**
+ * call on_nl(offset) for every '\n' in the text (scalar fallback)
+ */
+template<typename Func>
+static void scan_scalar(const char *p, std::size_t beg, std::size_t end, Func &on_nl)
+{
+    const char *it = p + beg;
+    const char *const last = p + end;
+    while ((it = static_cast<const char*>(std::memchr(it, '\n', last - it)))) {
+        on_nl(static_cast<std::size_t>(it - p));
+        if (++it == last)
+            break;
+    }
+}
+
+#ifdef LINES_X86
+/**
+ * 16 bytes per iteration, compare with '\n' & walk over the bits of the mask
+ */
+template<typename Func>
+__attribute__((target("sse2")))
+static std::size_t scan_sse2(const char *p, std::size_t size, Func &on_nl)
+{
+    const __m128i nl = _mm_set1_epi8('\n');
+    std::size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, nl)));
+        for (; mask; mask &= mask - 1)
+            on_nl(i + __builtin_ctz(mask));
+    }
+    return i; // offset of the not scanned tail
+}
+
+/**
+ * 32 bytes per iteration
+ */
+template<typename Func>
+__attribute__((target("avx2")))
+static std::size_t scan_avx2(const char *p, std::size_t size, Func &on_nl)
+{
+    const __m256i nl = _mm256_set1_epi8('\n');
+    std::size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, nl)));
+        for (; mask; mask &= mask - 1)
+            on_nl(i + __builtin_ctz(mask));
+    }
+    return i;
+}
+#endif
+
+/**
+ * dispatch to the widest newline scan supported by the cpu
+ */
+template<typename Func>
+static void scan_newlines(std::string_view s, Func on_nl)
+{
+    std::size_t tail = 0;
+#ifdef LINES_X86
+    static const bool has_avx2 = __builtin_cpu_supports("avx2");
+    static const bool has_sse2 = __builtin_cpu_supports("sse2");
+    if (has_avx2)
+        tail = scan_avx2(s.data(), s.size(), on_nl);
+    else if (has_sse2)
+        tail = scan_sse2(s.data(), s.size(), on_nl);
+#endif
+    if (tail < s.size())
+        scan_scalar(s.data(), tail, s.size(), on_nl);
+}
+
+std::size_t lines::count_newlines(std::string_view s)
+{
+    std::size_t nl {0};
+    scan_newlines(s, [&](std::size_t) { ++nl; });
+    return nl;
+}
+
+/**
+ * build line-offset table of the text
+ */
+lines::index_t lines::build_index(std::string_view s)
+{
+    lines::index_t idx {};
+    std::vector<std::size_t> &begs = idx.begs;
+    begs.reserve(s.size() / 32 + 2); // rough estimate of the lines count
+    scan_newlines(s, [&](std::size_t pos) { begs.push_back(pos + 1); });
+    // last line without trailing '\n' -> sentinel as if it was there
+    if (!s.empty() && s.back() != '\n')
+        begs.push_back(s.size() + 1);
+    return idx;
+}
+
+/**
+ * extend line-offset table of the text after appending to it,
+ * appended part starts at the sentinel of the table (just after the '\n' of the last indexed line)
+ */
+void lines::extend_index(lines::index_t &idx, std::string_view s)
+{
+    std::vector<std::size_t> &begs = idx.begs;
+    const std::size_t from = begs.back();
+    if (from >= s.size())
+        return; // nothing was appended
+    scan_newlines(s.substr(from), [&](std::size_t pos) { begs.push_back(from + pos + 1); });
+    if (s.back() != '\n')
+        begs.push_back(s.size() + 1);
+}
@@ -0,0 +1,38 @@
+#ifndef LINES_HPP
+#define LINES_HPP
+
+#include <algorithm> // min
+#include <cstddef>   // size_t
+#include <string_view>
+#include <vector>
+
+namespace lines
+{
+    /**
+     * line-offset table of the text, built once per loaded text by the vectorized newline scan.
+     * begs[i] is the offset of the i-th line, the last element is the sentinel
+     * (one past the '\n' of the last line, even if the text does not end by the '\n').
+     */
+    struct index_t {
+        std::vector<std::size_t> begs { 0 };
+
+        std::size_t count() const { return begs.size() - 1; }
+
+        // i-th line of the text without trailing '\n'
+        std::string_view line(std::string_view s, std::size_t i) const {
+            return s.substr(begs[i], begs[i + 1] - begs[i] - 1);
+        }
+        // slice of the text between line numbers (including trailing '\n' of the lines)
+        std::string_view slice(std::string_view s, std::size_t beg_nl, std::size_t end_nl) const {
+            const std::size_t beg = begs[beg_nl];
+            const std::size_t end = std::min(begs[end_nl], s.size());
+            return s.substr(beg, end - beg);
+        }
+    };
+
+    std::size_t count_newlines(std::string_view s);
+    lines::index_t build_index(std::string_view s);
+    void extend_index(lines::index_t &idx, std::string_view s);
+}
+
+#endif // LINES_HPP
@@ -1,8 +1,14 @@
 #include <QApplication>
 #include "mainwindow.hpp"
 
+#include "batch.hpp"
+
+#include <string_view>
+
 int main(int argc, char *argv[])
 {
+    if (argc > 1 && std::string_view(argv[1]) == "--batch")
+        return batch::run(argc - 1, argv + 1); // without window
     QApplication a(argc, argv);
     MainWindow w;
     w.show();
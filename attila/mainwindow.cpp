@@ -3,8 +3,18 @@
 
 #include "stats.hpp"
 #include "str.hpp"      // str namespace
+#include "fuzzy.hpp"    // fuzzy namespace
+#include "query.hpp"    // query namespace
+#include "topk.hpp"     // topk namespace
+#include "interval.hpp" // overlaps, idle gaps & utilization
+#include "mem.hpp"      // heap accounting per stage
+#include "diag.hpp"     // parse diagnostics
 
-#include <QtConcurrent/QtConcurrent>
+#include <QElapsedTimer>
+#include <QFile>
+
+#include <algorithm> // find_if, clamp, all_of, remove_if
+#include <regex>     // regex_error
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
@@ -19,17 +29,33 @@ MainWindow::MainWindow(QWidget *parent)
     typingTimer->setSingleShot(true); // timer will fire only once after it was started
 
     // filter only after the user has stopped typing for at least a short time (filter as you type)
-    connect(ui->filterInput, &QLineEdit::textChanged, this, [&](){ typingTimer->start(300); });
+    connect(ui->filterInput, &QLineEdit::textChanged, this, [&](){ typingTimer->start(filterDebounce()); });
     connect(typingTimer,     &QTimer::timeout,        this, &MainWindow::filterChanged);
 
+    // parsed week files of the span being loaded are redrawn at most a few times per second
+    chunkTimer = new QTimer(this);
+    chunkTimer->setSingleShot(true);
+    connect(chunkTimer, &QTimer::timeout, this, &MainWindow::spanChunksShow);
+
+    // debug overlay: heap usage per pipeline stage (F12)
+    memTimer = new QTimer(this);
+    connect(memTimer, &QTimer::timeout, this, &MainWindow::showMem);
+    memTimer->start(1000);
+    connect(ui->filterMode, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            this, &MainWindow::filterModeChanged);
+
     connect(ui->dateFr, &QDateEdit::dateChanged, this, &MainWindow::dateSpanChanged);
     connect(ui->dateTo, &QDateEdit::dateChanged, this, &MainWindow::dateSpanChanged);
 
     connect(ui->checkBoxMerge, &QCheckBox::stateChanged, this, &MainWindow::mergeToggle);
+    connect(ui->checkBoxNear,  &QCheckBox::stateChanged, this, &MainWindow::nearToggle);
+    connect(ui->sortMode, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &MainWindow::sortChanged);
+    connect(ui->checkBoxDesc, &QCheckBox::stateChanged, this, &MainWindow::sortChanged);
 
-    // parallel analysis of tasks in the background (non-blocking behavior)
-    connect(this, &MainWindow::analyzeTasksSignal, this, &MainWindow::analyzeTasksStarted);
-    connect(&vtt_watcher, &QFutureWatcher<ss::vtasks_t>::finished, this, &MainWindow::analyzeTasksFinished);
+    // live mode: parse lines appended to the current week file
+    live_watcher = new QFileSystemWatcher(this);
+    connect(ui->checkBoxLive, &QCheckBox::stateChanged, this, &MainWindow::liveToggle);
+    connect(live_watcher, &QFileSystemWatcher::fileChanged, this, &MainWindow::liveFileChanged);
 
     // at the end - after signal/slot connections
     MainWindow::startup();
@@ -37,6 +63,10 @@ MainWindow::MainWindow(QWidget *parent)
 
 MainWindow::~MainWindow()
 {
+    filterWait(); // background runs report to this window
+    spanWait();   // background loads report to this window
+    liveWait();   // & live refreshes
+    mergeWait();  // & merges
     delete ui;
 }
 
@@ -57,6 +87,9 @@ void MainWindow::stylesDefaults()
     fin = ui->filterInput;
     fin_ss_def = "QLineEdit{ color: white; }\nQLineEdit[text=\"\"]{ color: gray; }";
     fin->setStyleSheet(fin_ss_def); // fix: override placeholderText color by gray
+    ui->spanProgress->hide(); // shown only while the date span is being loaded
+    ui->memText->hide();      // debug overlay is toggled by F12
+    ui->diagLabel->hide();    // shown only if the loaded span has lines which are not tasks
 }
 
 /**
@@ -64,7 +97,7 @@ void MainWindow::stylesDefaults()
  */
 void MainWindow::setTabbingOrder()
 {
-    QWidget::setTabOrder(fin, ui->dateFr);
+    QWidget::setTabOrder(fin, ui->dateFr); // NOTE: filterMode is switched by the hotkey
     QWidget::setTabOrder(ui->dateFr, ui->dateTo);
     QWidget::setTabOrder(ui->dateTo, ui->scrollArea);
     QWidget::setTabOrder(ui->scrollArea, ui->scrollAreaWidgetContents);
@@ -85,19 +118,16 @@ void MainWindow::startup()
     dateSpanChanged();
 }
 
-void MainWindow::setTxt(const QString &txt)
-{
-    ui->previewText->setPlainText(txt);
-    qDebug() << "New text was set!";
-    emit analyzeTasksSignal(txt);
-}
-
 /**
  * calculate stats & display in spent tab header
  */
 void MainWindow::updateStats(const ss::vtasks_t &vtt)
 {
-    const ss::stats_t     stats = calculate_stats(vtt);
+    showStats(calculate_stats(vtt));
+}
+
+void MainWindow::showStats(const ss::stats_t &stats)
+{
     const ss::stats_human_t hum = calculate_stats_human(stats);
     ui->statsAvg->setPlainText("avg: " + QString::fromStdString(hum.avg));
     ui->statsMax->setPlainText("max: " + QString::fromStdString(hum.max));
@@ -113,47 +143,228 @@ void MainWindow::mergeToggle(int state)
         qDebug() << "Empty TXT_SPENT -> do nothing.";
         return;
     }
-    if (state) {
-        ui->spentText->setPlainText(TXT_MERGED);
+    if (state && merging)
+        return; // merged tasks of the current merge mode are displayed by mergeApply()
+    MainWindow::showSpent();
+    if (state)
         MainWindow::updateStats(vtt_merged);
-    } else {
-        ui->spentText->setPlainText(TXT_SPENT);
-        MainWindow::updateStats(vtt);
+    else
+        MainWindow::showStats(*spent_stats);
+}
+
+void MainWindow::sortChanged()
+{
+    if (TXT_SPENT.isEmpty())
+        return;
+    MainWindow::showSpent();
+}
+
+/**
+ * spent view is sorted by other than the order of the file
+ */
+bool MainWindow::sorted() const
+{
+    return ui->sortMode->currentIndex() != static_cast<int>(sortkey::by_t::FILE) || ui->checkBoxDesc->isChecked();
+}
+
+/**
+ * spent or merged tasks in the selected sort order: only the indices are sorted (by the packed keys)
+ * & the lines rendered again, keys are rebuilt only after the tasks have changed (live mode, merging)
+ */
+void MainWindow::showSpent()
+{
+    const bool merged = ui->checkBoxMerge->isChecked();
+    if (!MainWindow::sorted()) {
+        ui->spentText->setPlainText((merged) ? TXT_MERGED : TXT_SPENT);
+        return;
     }
+    const ss::vtasks_t &tasks = (merged) ? vtt_merged : vtt;
+    sortkey::keys_t &keys = (merged) ? merged_keys : spent_keys;
+    if (keys.size() != tasks.size())
+        keys = sortkey::build(tasks);
+    const auto by = static_cast<sortkey::by_t>(ui->sortMode->currentIndex());
+    const std::vector<std::uint32_t> order = sortkey::order(keys, by, ui->checkBoxDesc->isChecked());
+    ui->spentText->setPlainText(QString::fromStdString(str::tasks_to_mulstr(tasks, order)));
+    pts("[SORT] spent view is sorted!");
 }
 
-void MainWindow::merge()
+/**
+ * heap usage per stage & sizes of the texts & tasks of the window (debug overlay, F12)
+ */
+void MainWindow::showMem()
 {
-    if (TXT_SPENT.isEmpty()) {
-        qDebug() << "Empty TXT_SPENT -> do nothing.";
+    if (!ui->memText->isVisible())
+        return;
+    auto human = [](std::size_t bytes) { return QString::fromStdString(mem::human(static_cast<std::int64_t>(bytes))); };
+    QString txt = QString::fromStdString(mem::report(mem::snapshot()));
+    txt += QString("\nRAW %1 (line offsets %2)  TXT_RAW %3  TXT_FILTERED %4  TXT_SPENT %5  TXT_MERGED %6\n")
+           .arg(human(src->raw.capacity()), human(src->idx.begs.capacity() * sizeof(std::size_t)),
+                human(TXT_RAW.capacity() * sizeof(QChar)), human(TXT_FILTERED.capacity() * sizeof(QChar)),
+                human(TXT_SPENT.capacity() * sizeof(QChar)), human(TXT_MERGED.capacity() * sizeof(QChar)));
+    txt += QString("tasks: span %1, displayed %2, merged %3\n").arg(src->tasks.size()).arg(vtt.size()).arg(vtt_merged.size());
+    ui->memText->setPlainText(txt);
+}
+
+/**
+ * count of the lines which are not tasks, the details (file:line: reason) are in the tooltip
+ */
+void MainWindow::showDiag()
+{
+    if (!span_diag.total()) {
+        ui->diagLabel->hide();
         return;
     }
-    pts("[TASKS ANALYZING] before merge_tasks() call");
-    std::pair<const ss::vtasks_t, const std::string>
-        merged = merge_tasks(vtt, TXT_SPENT.toStdString());
-    vtt_merged = merged.first;
-    TXT_MERGED = QString::fromStdString(merged.second);
-    pts("[TASKS ANALYZING] merge finished!");
-    // update stats & spent text according to the state of the checkbox
+    ui->diagLabel->setText(QString("%1 lines skipped").arg(span_diag.total()));
+    ui->diagLabel->setToolTip(QString::fromStdString(diag::report(span_diag, span_fpaths)));
+    ui->diagLabel->show();
+}
+
+/**
+ * analyze tasks & display them (synchronously)
+ */
+void MainWindow::setTasks(const ss::vtasks_t &tasks)
+{
+    setAnalysis(analyze(tasks, ui->checkBoxNear->isChecked()));
+}
+
+/**
+ * spent text, stats, heatmap, top-K tables, intervals & merged tasks of the tasks
+ * (near -> near-duplicate tasks are merged, otherwise tasks with the same text).
+ * set cancellation token stops the analysis between the stages & inside the merge -> incomplete result
+ * NOTE: does not touch the widgets -> safe to call off the GUI thread
+ */
+MainWindow::analysis_t MainWindow::analyze(ss::vtasks_t tasks, bool near, const std::atomic<bool> *cancel)
+{
+    const mem::scope_t mscope(mem::stage_t::ANALYZE);
+    auto canceled = [cancel]() { return cancel && cancel->load(std::memory_order_relaxed); };
+    analysis_t a;
+    a.tasks = std::move(tasks);
+    a.near  = near;
+    if (a.tasks.empty())
+        return a;
+    a.stats = std::make_shared<const ss::stats_t>(calculate_stats(a.tasks));
+    a.spent   = QString::fromStdString(str::tasks_to_mulstr(a.tasks));
+    a.heatmap = QString::fromStdString(heatmap_to_str(calculate_heatmap(a.tasks, 15)));
+    if (canceled())
+        return a;
+    a.top     = QString::fromStdString(topk::report(a.tasks, top_k));
+    if (canceled())
+        return a;
+    a.intervals = QString::fromStdString(interval::report(interval::index_t(a.tasks), a.tasks, idle_min));
+    if (canceled())
+        return a;
+    // NOTE: all the tasks are in the spent text -> merged by the text hash (same as merge_tasks())
+    a.merged = (near) ? merge_tasks_near(a.tasks).first : merge_tasks_by_text(a.tasks, cancel);
+    if (canceled())
+        return a;
+    a.merged_txt  = QString::fromStdString(str::tasks_to_mulstr(a.merged));
+    a.keys        = sortkey::build(a.tasks);
+    a.merged_keys = sortkey::build(a.merged);
+    return a;
+}
+
+/**
+ * display already analyzed tasks (only the widgets are updated on the GUI thread)
+ */
+void MainWindow::setAnalysis(const analysis_t &a)
+{
+    ++live_seq; // displayed tasks are replaced -> live refreshes in flight are stale
+    ++merge_seq; // & merges
+    merging = false;
+    vtt = a.tasks;
+    spent_stats.reset();
+    if (a.stats)
+        spent_stats.emplace(*a.stats);
+    TXT_SPENT  = a.spent;
+    vtt_merged = a.merged;
+    TXT_MERGED = a.merged_txt;
+    spent_keys  = a.keys;
+    merged_keys = a.merged_keys;
+    ui->heatmapText->setPlainText(a.heatmap);
+    ui->topText->setPlainText(a.top);
+    ui->intervalText->setPlainText(a.intervals);
+    if (TXT_SPENT.isEmpty())
+        ui->spentText->clear();
+    if (a.near != ui->checkBoxNear->isChecked())
+        MainWindow::remerge(); // merge mode was switched while analyzing
+    // spent text & stats according to the state of the checkbox
     MainWindow::mergeToggle(ui->checkBoxMerge->isChecked());
+    pts("[TASKS ANALYZING] views are set!");
 }
 
-void MainWindow::analyzeTasksStarted(const QString &txt)
+/**
+ * start merging the displayed tasks again by the current merge mode (near-duplicates or the same texts)
+ * in the background (interactive lane), the previous merge (if any) is superseded
+ */
+void MainWindow::remerge()
 {
-    pts("[TASKS ANALYZING] started");
-    const std::string stdstr = txt.toStdString();
-    QFuture<ss::vtasks_t> future = QtConcurrent::run(parse_tasks_parallel, stdstr);
-    vtt_watcher.setFuture(future); // when computation is finished -> emit finished
+    const quint64 seq = ++merge_seq;
+    const bool near = ui->checkBoxNear->isChecked();
+    merging = true;
+    merge_runs.erase(std::remove_if(merge_runs.begin(), merge_runs.end(),
+                                    [](const auto &f) { return f.ready(); }),
+                     merge_runs.end());
+    merge_runs.push_back(exec::async_on(exec::lane_t::INTERACTIVE, [this, seq, tasks = vtt, near]() mutable {
+        merge_result_t r = runMerge(std::move(tasks), near);
+        QMetaObject::invokeMethod(this, [this, seq, r = std::move(r)]() {
+            mergeApply(seq, r);
+        }, Qt::QueuedConnection);
+    }));
 }
 
-void MainWindow::analyzeTasksFinished()
+/**
+ * merged tasks & their text (near -> near-duplicates, otherwise the same texts by the text hash).
+ * NOTE: does not touch the widgets -> safe to call off the GUI thread
+ */
+MainWindow::merge_result_t MainWindow::runMerge(ss::vtasks_t tasks, bool near)
 {
-    pts("[TASKS ANALYZING] finished");
-    vtt = vtt_watcher.result();
-    TXT_SPENT = QString::fromStdString(str::tasks_to_mulstr(vtt));
-    ui->spentText->setPlainText(TXT_SPENT);
-    pts("[TASKS ANALYZING] spent text is set!");
-    MainWindow::merge();
+    merge_result_t r;
+    r.near   = near;
+    r.merged = (near) ? merge_tasks_near(tasks).first : merge_tasks_by_text(tasks);
+    r.merged_txt = QString::fromStdString(str::tasks_to_mulstr(r.merged));
+    return r;
+}
+
+/**
+ * display the merged tasks (GUI thread), merges superseded by newer ones
+ * or by other displayed tasks (filter, date span, live append) are dropped
+ */
+void MainWindow::mergeApply(quint64 seq, const merge_result_t &r)
+{
+    if (seq != merge_seq)
+        return;
+    merging = false;
+    vtt_merged  = r.merged;
+    TXT_MERGED  = r.merged_txt;
+    merged_keys = {};
+    pts("[TASKS ANALYZING] tasks are merged again!");
+    if (ui->checkBoxMerge->isChecked())
+        MainWindow::mergeToggle(true);
+}
+
+/**
+ * wait for the merges in flight (they report to this window)
+ */
+void MainWindow::mergeWait()
+{
+    ++merge_seq;
+    for (auto &f : merge_runs)
+        f.wait();
+    merge_runs.clear();
+}
+
+/**
+ * switch merging of near-duplicate tasks ("fix lsp hover" ~ "Fix LSP hover."),
+ * near-duplicates are displayed merged -> merge is switched on as well
+ */
+void MainWindow::nearToggle(int state)
+{
+    if (!TXT_SPENT.isEmpty())
+        MainWindow::remerge();
+    if (state && !ui->checkBoxMerge->isChecked())
+        ui->checkBoxMerge->setChecked(true); // -> mergeToggle()
+    else
+        MainWindow::mergeToggle(ui->checkBoxMerge->isChecked());
 }
 
 void MainWindow::dateSpanChanged()
@@ -171,41 +382,581 @@ void MainWindow::dateSpanChanged()
         date_to = tmpdate;
     }
 
-    std::string fr = date_fr.toString("yyyy-MM-dd").toStdString();
-    std::string to = date_to.toString("yyyy-MM-dd").toStdString();
-    std::string content = concat_span(fr, to);
-    TXT_RAW = QString::fromStdString(content);
-    setTxt(TXT_RAW);
+    const std::string fr = date_fr.toString("yyyy-MM-dd").toStdString();
+    const std::string to = date_to.toString("yyyy-MM-dd").toStdString();
+    const quint64 seq = ++span_seq; // loads of the previous span are stale
+    span_loading = true;
+    span_chunks.clear();
+    span_chunks_stats.reset();
+    span_latest = {};
+    pts("[SPAN LOADING] started");
+    // the latest day is small -> on screen long before the whole span is read & parsed
+    if (fr != to)
+        spanLoad(seq, to, to, true);
+    spanLoad(seq, fr, to, false);
+}
+
+/**
+ * read & parse the date span & analyze its tasks (off the GUI thread)
+ */
+MainWindow::span_result_t MainWindow::loadSpan(const std::string &fr, const std::string &to, bool partial,
+                                               bool near, const progress_fn_t &progress)
+{
+    QElapsedTimer timer;
+    timer.start();
+    span_result_t r;
+    r.partial  = partial;
+    r.span     = load_span(fr, to, progress); // files are read & parsed concurrently
+    r.txt      = QString::fromStdString(r.span.content);
+    r.analysis = analyze(r.span.vtt, near);
+    r.msec     = timer.elapsed();
+    return r;
+}
+
+/**
+ * load the date span in the background & display it when finished,
+ * parsed week files of the whole span are displayed as soon as they are ready.
+ * the latest day is loaded on the interactive lane, the whole span on the background lane
+ */
+void MainWindow::spanLoad(quint64 seq, const std::string &fr, const std::string &to, bool partial)
+{
+    progress_fn_t progress;
+    if (!partial) {
+        // called from the parsing threads: spent text & stats of the chunk are prepared there,
+        // the chunk is queued to the GUI thread
+        progress = [this, seq](std::size_t done, std::size_t total, const ss::vtasks_t &tasks) {
+            const mem::scope_t mscope(mem::stage_t::ANALYZE);
+            span_chunk_t c;
+            if (!tasks.empty()) {
+                c.beg   = tasks.front().hm_t.beg;
+                c.end   = tasks.back().hm_t.beg;
+                c.spent = QString::fromStdString(str::tasks_to_mulstr(tasks));
+                c.stats = std::make_shared<const ss::stats_t>(calculate_stats(tasks));
+            }
+            QMetaObject::invokeMethod(this, [this, seq, done, total, c]() {
+                spanChunk(seq, done, total, c);
+            }, Qt::QueuedConnection);
+        };
+    }
+    span_runs.erase(std::remove_if(span_runs.begin(), span_runs.end(),
+                                   [](const auto &f) { return f.ready(); }),
+                    span_runs.end());
+    const bool near = ui->checkBoxNear->isChecked();
+    const exec::lane_t lane = (partial) ? exec::lane_t::INTERACTIVE : exec::lane_t::BACKGROUND;
+    span_runs.push_back(exec::async_on(lane, [this, seq, fr, to, partial, near, progress]() {
+        span_result_t r = loadSpan(fr, to, partial, near, progress);
+        QMetaObject::invokeMethod(this, [this, seq, r = std::move(r)]() mutable {
+            spanApply(seq, std::move(r));
+        }, Qt::QueuedConnection);
+    }));
+}
+
+/**
+ * wait for the loads in flight (their chunks are queued to this window)
+ */
+void MainWindow::spanWait()
+{
+    ++span_seq; // results of the loads in flight are stale
+    for (auto &f : span_runs)
+        f.wait();
+    span_runs.clear();
+}
+
+/**
+ * parsed week file of the span being loaded (GUI thread): progress & stats are updated at once,
+ * spent text of the parsed files (in the order of the tasks) is redrawn by the chunk timer.
+ * NOTE: filtered views are left untouched until the whole span is filtered
+ */
+void MainWindow::spanChunk(quint64 seq, std::size_t done, std::size_t total, const span_chunk_t &c)
+{
+    if (seq != span_seq || !span_loading)
+        return;
+    ui->spanProgress->setMaximum(static_cast<int>(total));
+    ui->spanProgress->setValue(static_cast<int>(done));
+    ui->spanProgress->show();
+    if (!c.stats || !fin->text().isEmpty())
+        return;
+    // latest day is in the parsed file -> do not display it twice
+    if (!span_latest.spent.isEmpty() && c.beg <= span_latest.beg && span_latest.beg <= c.end)
+        span_latest = {};
+    span_chunks.emplace(c.beg, c.spent);
+    if (span_chunks_stats)
+        span_chunks_stats.emplace(add_stats(*span_chunks_stats, *c.stats));
+    else
+        span_chunks_stats.emplace(*c.stats);
+    MainWindow::showStats(*span_chunks_stats);
+    if (!chunkTimer->isActive())
+        chunkTimer->start(250);
+}
+
+/**
+ * redraw spent text of the parsed week files (followed by the latest day if not parsed yet)
+ */
+void MainWindow::spanChunksShow()
+{
+    if (!span_loading || span_chunks.empty() || !fin->text().isEmpty())
+        return;
+    QString txt;
+    for (const auto &[beg, spent] : span_chunks)
+        txt += spent;
+    txt += span_latest.spent;
+    ui->spentText->setPlainText(txt);
+    pts(QString("[SPAN LOADING] %1 parsed week files are displayed").arg(span_chunks.size()));
+}
+
+/**
+ * display the loaded span (GUI thread), loads of the superseded spans are dropped
+ * & the latest day is dropped if the whole span is already displayed
+ */
+void MainWindow::spanApply(quint64 seq, span_result_t r)
+{
+    if (seq != span_seq || (r.partial && !span_loading))
+        return;
+    filterCancel(); // NOTE: runs in flight keep their snapshots of the previous span
+    src = std::make_shared<source_t>(source_t {
+        std::move(r.span.content), std::move(r.span.idx), std::move(r.span.vtt) });
+    TXT_RAW = std::move(r.txt);
+    ui->previewText->setPlainText(TXT_RAW);
+    pts(QString("[SPAN LOADING] %1 is loaded, load took %2 ms")
+        .arg((r.partial) ? "latest day" : "whole span").arg(r.msec));
+    if (r.partial) {
+        if (!src->tasks.empty()) {
+            span_latest.beg   = src->tasks.front().hm_t.beg;
+            span_latest.spent = r.analysis.spent;
+        }
+        if (!fin->text().isEmpty())
+            filterChanged();
+        else if (span_chunks.empty())
+            setAnalysis(r.analysis);
+        else
+            spanChunksShow(); // parsed week files are displayed already -> latest day after them
+        return;
+    }
+    span_loading = false;
+    chunkTimer->stop();
+    span_chunks.clear();
+    span_chunks_stats.reset();
+    span_latest = {};
+    ui->spanProgress->hide();
+    span_diag   = std::move(r.span.diag);
+    span_fpaths = std::move(r.span.fpaths);
+    span_fsizes = std::move(r.span.fsizes);
+    if (span_diag.total())
+        pts(QString("[SPAN LOADING] %1").arg(QString::fromStdString(diag::summary(span_diag))));
+    showDiag();
     // try to apply filter back after changing the date span
-    if (!fin->text().isEmpty())
+    if (fin->text().isEmpty())
+        setAnalysis(r.analysis); // already parsed -> no need to analyze the raw text again
+    else
         filterChanged();
+    if (ui->checkBoxLive->isChecked())
+        liveStart(); // the current week file was re-read -> continue after its last line
 }
 
+/**
+ * start filtering in the background (interactive lane), the previous run (if any) is superseded
+ */
 void MainWindow::filterChanged()
 {
-    const QString pattern = fin->text();
-    if (pattern.isEmpty()) {
-        setTxt(TXT_RAW); // set back not filtered text after clearing filter pattern
-        fin->setStyleSheet(fin_ss_def);
+    if (filter_cancel)
+        filter_cancel->store(true);
+    const quint64 seq = ++filter_seq;
+    const int mode = ui->filterMode->currentIndex();
+    const std::string pattern = fin->text().toStdString();
+    const bool near = ui->checkBoxNear->isChecked();
+    auto cancel = std::make_shared<std::atomic<bool>>(false);
+    filter_cancel = cancel;
+
+    filter_runs.erase(std::remove_if(filter_runs.begin(), filter_runs.end(),
+                                     [](const auto &f) { return f.ready(); }),
+                      filter_runs.end());
+    // NOTE: the run holds its snapshot -> raw text & tasks may be replaced or appended meanwhile
+    std::shared_ptr<const source_t> snapshot = src;
+    filter_runs.push_back(exec::async_on(exec::lane_t::INTERACTIVE,
+                                         [this, seq, mode, pattern, near, cancel, snapshot]() {
+        filter_result_t r = runFilter(mode, pattern, near, *snapshot, *cancel);
+        QMetaObject::invokeMethod(this, [this, seq, r = std::move(r)]() {
+            filterApply(seq, r);
+        }, Qt::QueuedConnection);
+    }));
+}
+
+/**
+ * select tasks by the pattern of the filter mode & analyze them (off the GUI thread):
+ * regex -> matching lines, fuzzy -> ranked by the score, query -> structured filter.
+ * empty pattern selects all tasks of the span.
+ * every stage checks the cancellation token -> superseded run ends early as CANCELED
+ */
+MainWindow::filter_result_t MainWindow::runFilter(int mode, const std::string &pattern, bool near,
+                                                  const source_t &src, const std::atomic<bool> &cancel)
+{
+    const std::string &raw = src.raw;
+    const ss::vtasks_t &tasks = src.tasks;
+    const mem::scope_t mscope(mem::stage_t::FILTER);
+    QElapsedTimer timer;
+    timer.start();
+    filter_result_t r;
+    auto done = [&](filter_result_t::status_t status) {
+        r.status = status;
+        r.msec = timer.elapsed();
+        return r;
+    };
+
+    ss::vtasks_t selected;
+    if (pattern.empty()) {
+        selected = tasks; // not filtered -> preview of the raw text
+    } else if (mode == FILTER_FUZZY) {
+        const std::vector<fuzzy::hit_t> hits = fuzzy::top_k(tasks, pattern, fuzzy_k, &cancel);
+        if (cancel)
+            return done(filter_result_t::CANCELED);
+        if (hits.empty())
+            return done(filter_result_t::NO_MATCH);
+        selected.reserve(hits.size());
+        for (const auto &hit : hits)
+            selected.push_back(tasks[hit.index]);
+        r.preview = sourceLines(selected);
+    } else if (mode == FILTER_QUERY) {
+        query::filter_t qf(pattern);
+        if (!qf.ok()) {
+            r.error = QString::fromStdString(qf.error());
+            return done(filter_result_t::INVALID);
+        }
+        selected = qf.filter(tasks, &cancel);
+        if (cancel)
+            return done(filter_result_t::CANCELED);
+        if (selected.empty())
+            return done(filter_result_t::NO_MATCH);
+        r.preview = sourceLines(selected);
+    } else {
+        // NOTE: validated & matched by the same engine (DFA or ECMAScript std::regex, not PCRE)
+        const std::string error = filter_error(pattern);
+        if (!error.empty()) {
+            r.error = QString::fromStdString(error);
+            return done(filter_result_t::INVALID);
+        }
+        try {
+            const std::string filtered = filter_find(raw, src.idx, pattern, &cancel);
+            if (cancel)
+                return done(filter_result_t::CANCELED);
+            if (filtered.empty())
+                return done(filter_result_t::NO_MATCH);
+            r.preview = QString::fromStdString(filtered);
+            // tasks of the filtered lines (already parsed -> no analysis of the filtered text)
+            selected = filter_tasks(tasks, pattern, &cancel);
+        } catch (const std::regex_error &e) {
+            r.error = QString::fromStdString(e.what()); // e.g. too complex for std::regex
+            return done(filter_result_t::INVALID);
+        }
+    }
+    if (cancel)
+        return done(filter_result_t::CANCELED);
+    r.analysis = analyze(std::move(selected), near, &cancel);
+    return done((cancel) ? filter_result_t::CANCELED : filter_result_t::OK);
+}
+
+/**
+ * source lines of the selected tasks (preview of the fuzzy & query filters)
+ */
+QString MainWindow::sourceLines(const ss::vtasks_t &tasks)
+{
+    std::string txt;
+    for (const auto &t : tasks)
+        txt += t.dts + ' ' + t.text + '\n'; // NOTE: same as the source line of the task
+    return QString::fromStdString(txt);
+}
+
+/**
+ * display the result of the filter run (GUI thread), results of the superseded runs are dropped
+ */
+void MainWindow::filterApply(quint64 seq, const filter_result_t &r)
+{
+    if (r.status != filter_result_t::CANCELED)
+        filter_cost = (filter_cost == 0) ? r.msec : 0.7 * filter_cost + 0.3 * r.msec;
+    if (seq != filter_seq)
+        return; // superseded by the newer pattern
+    switch (r.status) {
+    case filter_result_t::CANCELED:
+        return;
+    case filter_result_t::INVALID:
+        fin->setStyleSheet("color: red"); // indicate not valid pattern by the text color
+        qDebug() << "Not valid filter pattern:" << r.error;
+        return;
+    case filter_result_t::NO_MATCH:
+        fin->setStyleSheet("color: magenta");
+        qDebug() << "No matches to the filter pattern";
+        return;
+    case filter_result_t::OK:
+        break;
+    }
+    fin->setStyleSheet(fin_ss_def);
+    TXT_FILTERED = r.preview;
+    ui->previewText->setPlainText((r.preview.isNull()) ? TXT_RAW : r.preview);
+    setAnalysis(r.analysis);
+    pts(QString("[FILTER] applied, run took %1 ms").arg(r.msec));
+}
+
+/**
+ * cancel the filter runs in flight without waiting for them (they read their own snapshots),
+ * returns true if some run was dropped -> views may not correspond to the filter input
+ */
+bool MainWindow::filterCancel()
+{
+    ++filter_seq; // results of the runs in flight are stale
+    if (filter_cancel)
+        filter_cancel->store(true);
+    const auto ready = [](const auto &f) { return f.ready(); };
+    const bool dropped = !std::all_of(filter_runs.begin(), filter_runs.end(), ready);
+    filter_runs.erase(std::remove_if(filter_runs.begin(), filter_runs.end(), ready), filter_runs.end());
+    return dropped;
+}
+
+/**
+ * cancel the filter runs in flight & wait for them (they report to this window)
+ */
+void MainWindow::filterWait()
+{
+    filterCancel();
+    for (auto &f : filter_runs)
+        f.wait();
+    filter_runs.clear();
+}
+
+/**
+ * debounce interval of the filter as you type adapted to the cost of the recent runs:
+ * cheap runs -> almost immediate, expensive runs -> fewer superseded runs while typing
+ */
+int MainWindow::filterDebounce() const
+{
+    return std::clamp(static_cast<int>(50 + 2 * filter_cost), 50, 750);
+}
+
+void MainWindow::filterModeChanged(int index)
+{
+    switch (index) {
+    case FILTER_FUZZY:
+        fin->setPlaceholderText("fuzzy search");
+        break;
+    case FILTER_QUERY:
+        fin->setPlaceholderText("query: project:nvim duration>30m weekday:mon-fri text~lsp");
+        break;
+    default:
+        fin->setPlaceholderText("filter regex");
+        break;
+    }
+    if (!fin->text().isEmpty())
+        filterChanged();
+}
+
+void MainWindow::liveToggle(int state)
+{
+    if (!state) {
+        if (!live_watcher->files().isEmpty())
+            live_watcher->removePaths(live_watcher->files());
+        qDebug() << "Live mode is off.";
+        return;
+    }
+    if (date_to < QDate::currentDate()) {
+        ui->dateTo->setDate(QDate::currentDate()); // -> dateSpanChanged() -> liveStart()
         return;
     }
+    if (span_loading)
+        return; // started when the whole span is displayed
+    liveStart();
+}
+
+/**
+ * (re)start watching the current week files of the roots from their last lines
+ */
+void MainWindow::liveStart()
+{
+    if (!live_watcher->files().isEmpty())
+        live_watcher->removePaths(live_watcher->files());
+    if (date_to < QDate::currentDate()) {
+        qDebug() << "Live mode: date span does not include today.";
+        ui->checkBoxLive->setChecked(false);
+        return;
+    }
+    const std::vector<std::string> roots = task_roots();
+    live_tails.clear();
+    for (std::size_t i = 0; i < roots.size(); i++) {
+        const std::string fpath = find_last_week_file(roots[i]);
+        if (fpath.empty() || str::is_compressed(fpath)) {
+            qDebug() << "Live mode: no plain current week file in" << QString::fromStdString(roots[i]);
+            continue;
+        }
+        live_tails.push_back(tail_after_span(span_fpaths, span_fsizes, fpath));
+        live_tails.back().root = static_cast<std::uint16_t>(i);
+        live_watcher->addPath(QString::fromStdString(fpath));
+        qDebug() << "Live mode: watching" << QString::fromStdString(fpath);
+    }
+}
+
+void MainWindow::liveFileChanged(const QString &path)
+{
+    const std::string fpath = path.toStdString();
+    auto it = std::find_if(live_tails.begin(), live_tails.end(),
+                           [&](const tail::state_t &t) { return t.fpath == fpath; });
+    if (it == live_tails.end() || span_loading)
+        return; // the span being loaded is re-read -> tailing is restarted after it
+    std::string appended;
+    switch (tail::read(*it, appended)) {
+    case tail::status_t::unchanged:
+        break;
+    case tail::status_t::appended:
+        liveAppend(appended, it->root);
+        break;
+    case tail::status_t::rewritten:
+        qDebug() << "Live mode: file was truncated or rewritten -> full rescan.";
+        dateSpanChanged(); // -> liveStart()
+        return;
+    }
+    // appended lines are displayed -> restarted live mode continues after them
+    const auto f = std::find(span_fpaths.begin(), span_fpaths.end(), fpath);
+    const std::size_t fi = static_cast<std::size_t>(f - span_fpaths.begin());
+    if (fi < span_fsizes.size())
+        span_fsizes[fi] = it->offset;
+    // file replaced by the rename (editors save this way) is not watched anymore
+    if (!live_watcher->files().contains(path) && QFile::exists(path))
+        live_watcher->addPath(path);
+}
+
+/**
+ * parse only the appended lines & extend texts, tasks, stats & merged tasks by them
+ */
+void MainWindow::liveAppend(const std::string &appended, std::uint16_t root)
+{
+    pts("[LIVE] appended lines");
+    diag::log_t log(static_cast<std::uint32_t>(span_fpaths.size()), 0); // NOTE: file & line are not known
+    ss::vtasks_t tasks = parse_tasks(appended, &log);
+    if (log.total()) {
+        span_diag.merge(log);
+        showDiag();
+    }
+    for (auto &t : tasks)
+        t.root = root;
+    const QString txt = QString::fromStdString(appended);
+    auto append = [](QPlainTextEdit *edit, const QString &txt) {
+        if (edit->document()->isEmpty())
+            edit->setPlainText(txt);
+        else
+            edit->appendPlainText(txt.chopped(1)); // NOTE: new paragraph -> without trailing '\n'
+    };
 
-    re_filter = QRegularExpression(pattern);
-    if (!re_filter.isValid()) {
-        fin->setStyleSheet("color: red"); // indicate not valid regex by the text color
-        qDebug() << "Not valid filter regex";
+    const bool dropped = filterCancel();
+    // NOTE: only this thread takes new references -> not shared now means not shared while modified
+    if (src.use_count() > 1)
+        src = std::make_shared<source_t>(*src); // filter runs in flight keep the old snapshot
+    // raw text is trimmed (without trailing '\n') after loading of the date span
+    if (!src->raw.empty() && src->raw.back() != '\n')
+        src->raw += '\n';
+    src->raw += appended;
+    lines::extend_index(src->idx, src->raw);
+    if (!TXT_RAW.isEmpty() && !TXT_RAW.endsWith('\n'))
+        TXT_RAW += '\n';
+    TXT_RAW += txt;
+    src->tasks.insert(src->tasks.end(), tasks.begin(), tasks.end());
+
+    if (!fin->text().isEmpty() || dropped) {
+        filterChanged(); // filtered views -> filter again
+        return;
+    }
+    append(ui->previewText, txt);
+    if (tasks.empty())
         return;
+
+    vtt.insert(vtt.end(), tasks.begin(), tasks.end());
+    spent_keys = {};
+    const ss::stats_t stats = (spent_stats) ? add_stats(*spent_stats, calculate_stats(tasks))
+                                            : calculate_stats(tasks);
+    spent_stats.emplace(stats);
+    const QString spent = QString::fromStdString(str::tasks_to_mulstr(tasks));
+    TXT_SPENT += spent;
+    // NOTE: near-duplicates are merged again by the refresh -> appended task may join any cluster
+    const bool near = ui->checkBoxNear->isChecked();
+    if (merging) {
+        MainWindow::remerge(); // merged tasks are of the previous merge mode -> merged again with the appended
+    } else if (!near) {
+        merge_tasks_append(vtt_merged, tasks);
+        TXT_MERGED = QString::fromStdString(str::tasks_to_mulstr(vtt_merged));
+        merged_keys = {};
+    }
+    if (ui->checkBoxMerge->isChecked()) {
+        if (!near && !merging) {
+            MainWindow::showSpent();
+            MainWindow::updateStats(vtt_merged);
+        }
     } else {
-        fin->setStyleSheet(fin_ss_def);
+        if (MainWindow::sorted())
+            MainWindow::showSpent(); // appended tasks may be anywhere in the order
+        else
+            append(ui->spentText, spent);
+        MainWindow::showStats(*spent_stats);
     }
+    pts("[LIVE] appended tasks are displayed!");
 
-    const std::string filtered = filter_find(TXT_RAW.toStdString(), re_filter.pattern().toStdString());
-    if (filtered.empty()) {
-        fin->setStyleSheet("color: magenta");
-        qDebug() << "No matches to the filter regex";
+    // views over all displayed tasks are rebuilt off the GUI thread, only the latest refresh is applied
+    const quint64 seq = ++live_seq;
+    live_runs.erase(std::remove_if(live_runs.begin(), live_runs.end(),
+                                   [](const auto &f) { return f.ready(); }),
+                    live_runs.end());
+    live_runs.push_back(exec::async_on(exec::lane_t::NORMAL, [this, seq, tasks = vtt, near]() mutable {
+        live_result_t r = liveAnalyze(std::move(tasks), near);
+        QMetaObject::invokeMethod(this, [this, seq, r = std::move(r)]() {
+            liveApply(seq, r);
+        }, Qt::QueuedConnection);
+    }));
+}
+
+/**
+ * heatmap, top-K tables, intervals (& near-duplicates merged again) of all displayed tasks.
+ * NOTE: does not touch the widgets -> safe to call off the GUI thread
+ */
+MainWindow::live_result_t MainWindow::liveAnalyze(ss::vtasks_t tasks, bool near)
+{
+    const mem::scope_t mscope(mem::stage_t::ANALYZE);
+    live_result_t r;
+    r.heatmap   = QString::fromStdString(heatmap_to_str(calculate_heatmap(tasks, 15)));
+    r.top       = QString::fromStdString(topk::report(tasks, top_k));
+    r.intervals = QString::fromStdString(interval::report(interval::index_t(tasks), tasks, idle_min));
+    r.near = near;
+    if (near) {
+        std::pair<const ss::vtasks_t, const std::string> merged = merge_tasks_near(tasks);
+        r.merged     = merged.first;
+        r.merged_txt = QString::fromStdString(merged.second);
+    }
+    return r;
+}
+
+/**
+ * display the live refresh (GUI thread), refreshes superseded by newer appends
+ * or by other displayed tasks (filter, date span) are dropped
+ */
+void MainWindow::liveApply(quint64 seq, const live_result_t &r)
+{
+    if (seq != live_seq)
         return;
+    ui->heatmapText->setPlainText(r.heatmap);
+    ui->topText->setPlainText(r.top);
+    ui->intervalText->setPlainText(r.intervals);
+    if (r.near && ui->checkBoxNear->isChecked() && !merging) {
+        vtt_merged  = r.merged;
+        TXT_MERGED  = r.merged_txt;
+        merged_keys = {};
+        if (ui->checkBoxMerge->isChecked()) {
+            MainWindow::showSpent();
+            MainWindow::updateStats(vtt_merged);
+        }
     }
+    pts("[LIVE] views are updated!");
+}
 
-    TXT_FILTERED = QString::fromStdString(filtered);
-    setTxt(TXT_FILTERED);
+/**
+ * wait for the live refreshes in flight (they report to this window)
+ */
+void MainWindow::liveWait()
+{
+    ++live_seq;
+    for (auto &f : live_runs)
+        f.wait();
+    live_runs.clear();
 }
@@ -5,8 +5,7 @@
 #include <QDebug>
 
 #include <QDate>
-#include <QFutureWatcher>
-#include <QRegularExpression>
+#include <QFileSystemWatcher>
 #include <QTimer>
 
 #include <QLineEdit>
@@ -16,6 +15,15 @@
 #include "stats.hpp"
 #include "attila.hpp"
 #include "keys.hpp"
+#include "tail.hpp"
+#include "exec.hpp"     // shared thread pool
+#include "sortkey.hpp"  // sort keys of the spent view
+
+#include <atomic>
+#include <ctime>    // time_t
+#include <map>
+#include <memory>   // shared_ptr
+#include <optional>
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class MainWindow; }
@@ -29,17 +37,91 @@ public:
     MainWindow(QWidget *parent = nullptr);
     ~MainWindow();
 
-signals:
-    void analyzeTasksSignal(const QString &txt);
-
 private slots:
-    void analyzeTasksStarted(const QString &txt);
-    void analyzeTasksFinished();
     void dateSpanChanged();
     void filterChanged();
+    void filterModeChanged(int index);
     void mergeToggle(int state);
+    void sortChanged();
+    void nearToggle(int state);
+    void liveToggle(int state);
+    void liveFileChanged(const QString &path);
 
 private:
+    /**
+     * everything derived from the selected tasks, computed off the GUI thread
+     */
+    struct analysis_t {
+        ss::vtasks_t tasks {};
+        std::shared_ptr<const ss::stats_t> stats {}; // null -> no tasks (NOTE: stats_t is not assignable)
+        QString spent {};
+        QString heatmap {};
+        QString top {};
+        QString intervals {};
+        ss::vtasks_t merged {};
+        QString merged_txt {};
+        sortkey::keys_t keys {};        // sort keys of the tasks
+        sortkey::keys_t merged_keys {}; // & of the merged tasks
+        bool near {false}; // merged near-duplicates (otherwise the same texts)
+    };
+
+    /**
+     * raw text & tasks of the date span, each filter run holds the snapshot it started with
+     * (GUI thread copies the shared one before modifying it -> runs in flight are not waited for)
+     */
+    struct source_t {
+        std::string    raw {};   // raw text of the date span
+        lines::index_t idx {};   // line-offset table of the raw text (built once per loaded span)
+        ss::vtasks_t   tasks {}; // tasks of the whole date span (parsed while loading)
+    };
+
+    struct filter_result_t {
+        enum status_t { OK, INVALID, NO_MATCH, CANCELED } status { CANCELED };
+        QString error {};
+        QString preview {}; // null -> not filtered raw text
+        analysis_t analysis {};
+        qint64 msec {0};    // duration of the run
+    };
+
+    /**
+     * tasks of one parsed week file, displayed while the rest of the span is being loaded
+     */
+    struct span_chunk_t {
+        std::time_t beg {0}; // beginning of the first & the last task
+        std::time_t end {0};
+        QString spent {};
+        std::shared_ptr<const ss::stats_t> stats {};
+    };
+
+    /**
+     * views of all displayed tasks refreshed after the live append, computed off the GUI thread
+     */
+    struct live_result_t {
+        QString heatmap {};
+        QString top {};
+        QString intervals {};
+        bool near {false}; // near-duplicates were merged again -> merged tasks
+        ss::vtasks_t merged {};
+        QString merged_txt {};
+    };
+
+    /**
+     * displayed tasks merged again after switching the merge mode, computed off the GUI thread
+     */
+    struct merge_result_t {
+        bool near {false}; // merged near-duplicates (otherwise the same texts)
+        ss::vtasks_t merged {};
+        QString merged_txt {};
+    };
+
+    struct span_result_t {
+        ss::span_t span {};
+        QString txt {};      // raw text of the span
+        analysis_t analysis {};
+        bool partial {false}; // only the latest day of the span
+        qint64 msec {0};      // duration of the load
+    };
+
     void pts(const QString);
 
     void stylesDefaults();
@@ -47,11 +129,49 @@ private:
     void setLastWeekSpan();
     void startup();
 
-    void setTxt(const QString &txt);
-    void merge();
+    static span_result_t loadSpan(const std::string &fr, const std::string &to, bool partial,
+                                  bool near, const progress_fn_t &progress);
+    void spanLoad(quint64 seq, const std::string &fr, const std::string &to, bool partial);
+    void spanApply(quint64 seq, span_result_t r);
+    void spanChunk(quint64 seq, std::size_t done, std::size_t total, const span_chunk_t &c);
+    void spanChunksShow();
+    void spanWait();
+
+    static filter_result_t runFilter(int mode, const std::string &pattern, bool near,
+                                     const source_t &src, const std::atomic<bool> &cancel);
+    static analysis_t analyze(ss::vtasks_t tasks, bool near, const std::atomic<bool> *cancel = nullptr);
+    static QString sourceLines(const ss::vtasks_t &tasks);
+    void filterApply(quint64 seq, const filter_result_t &r);
+    bool filterCancel();
+    void filterWait();
+    int  filterDebounce() const;
+
+    void setTasks(const ss::vtasks_t &tasks);
+    void setAnalysis(const analysis_t &a);
+    void remerge();
+    static merge_result_t runMerge(ss::vtasks_t tasks, bool near);
+    void mergeApply(quint64 seq, const merge_result_t &r);
+    void mergeWait();
+    bool sorted() const;
+    void showSpent();
     void updateStats(const ss::vtasks_t &vtt);
+    void showStats(const ss::stats_t &stats);
+    void showMem();
+    void showDiag();
+
+    void liveStart();
+    void liveAppend(const std::string &appended, std::uint16_t root);
+    static live_result_t liveAnalyze(ss::vtasks_t tasks, bool near);
+    void liveApply(quint64 seq, const live_result_t &r);
+    void liveWait();
 
 private:
+    enum filter_mode_t { FILTER_REGEX, FILTER_FUZZY, FILTER_QUERY }; // filterMode combo box items
+
+    static constexpr std::size_t fuzzy_k { 1000 }; // max number of the ranked fuzzy hits
+    static constexpr std::size_t top_k   { 10 };   // rows of the top-K tables
+    static constexpr std::time_t idle_min { 30 * 60 }; // shortest listed idle gap (sec)
+
     Ui::MainWindow  *ui;
     class Keys      *ks;
 
@@ -62,7 +182,27 @@ private:
     QDate date_to;
 
     QTimer *typingTimer;
-    QRegularExpression re_filter;
+    QTimer *memTimer; // refreshes the debug overlay
+
+    // background filtering: a newer run supersedes (cancels) the older one
+    quint64 filter_seq { 0 };                         // latest requested run
+    std::shared_ptr<std::atomic<bool>> filter_cancel; // cancellation token of the latest run
+    std::vector<exec::future_t<void>> filter_runs;    // runs in flight (read their snapshots of the src)
+    double filter_cost { 0 };                         // moving average of the run duration (ms)
+
+    // background span loading: the latest day first, then the whole span
+    quint64 span_seq { 0 };         // latest requested date span
+    bool    span_loading { false }; // the whole span is not displayed yet
+    std::vector<exec::future_t<void>> span_runs;       // loads in flight (report chunks to this window)
+    std::multimap<std::time_t, QString> span_chunks;   // spent text of the parsed week files by beginning
+    std::optional<ss::stats_t> span_chunks_stats;      // stats of the parsed week files
+    span_chunk_t span_latest;                          // latest day (displayed after the parsed week files)
+    QTimer *chunkTimer;                                // coalesces redrawing of the parsed week files
+    diag::log_t span_diag;                             // lines of the loaded span which are not tasks
+    std::vector<std::string> span_fpaths;              // week files of the loaded span (diagnostics)
+    std::vector<std::uintmax_t> span_fsizes;           // bytes read of them (live mode continues there)
+
+    std::shared_ptr<source_t> src { std::make_shared<source_t>() }; // raw text & tasks of the date span
 
     QString TXT_RAW;
     QString TXT_FILTERED;
@@ -71,6 +211,18 @@ private:
 
     ss::vtasks_t vtt;
     ss::vtasks_t vtt_merged;
-    QFutureWatcher<ss::vtasks_t> vtt_watcher;
+    sortkey::keys_t spent_keys;  // sort keys of the vtt (cleared when the tasks change)
+    sortkey::keys_t merged_keys; // & of the vtt_merged
+    std::optional<ss::stats_t> spent_stats; // stats of the vtt (updated incrementally in live mode)
+
+    // background merging after switching the merge mode: only the latest merge is applied
+    quint64 merge_seq { 0 };                      // latest merge (the displayed tasks it is based on)
+    bool    merging { false };                    // vtt_merged is of the previous merge mode until applied
+    std::vector<exec::future_t<void>> merge_runs; // merges in flight (report to this window)
+
+    QFileSystemWatcher *live_watcher;
+    std::vector<tail::state_t> live_tails; // one per root
+    quint64 live_seq { 0 };                      // latest live refresh (the displayed tasks it is based on)
+    std::vector<exec::future_t<void>> live_runs; // refreshes in flight (report to this window)
 };
 #endif // MAINWINDOW_HPP
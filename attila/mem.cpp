@@ -0,0 +1,197 @@
+#include <atomic>
+#include <cstddef> // size_t
+#include <cstdint> // int64_t, uint64_t, uint8_t
+#include <string>
+
+#include <fmt/core.h>
+
+#include "mem.hpp"
+
+using mem::stage_t;
+
+namespace
+{
+    thread_local stage_t tls_stage { stage_t::OTHER };
+    std::atomic<bool> hooked { false }; // the hooks of memhooks.cpp are linked in
+
+    constexpr std::int64_t  flush_bytes { 64 * 1024 }; // pending bytes of the thread & stage
+    constexpr std::uint64_t flush_ops   { 256 };       // pending allocations & frees
+
+    struct shared_t {
+        std::atomic<std::int64_t>  current {0};
+        std::atomic<std::int64_t>  peak    {0};
+        std::atomic<std::uint64_t> allocs  {0};
+        std::atomic<std::uint64_t> frees   {0};
+        std::atomic<std::uint64_t> bytes   {0};
+    };
+    shared_t shared[mem::nstages + 1]; // the last one is the total
+
+    struct pending_t {
+        std::int64_t  delta  {0};
+        std::uint64_t allocs {0};
+        std::uint64_t frees  {0};
+        std::uint64_t bytes  {0};
+    };
+
+    // NOTE: trivially destructible -> usable by the hooks until the very end of the thread
+    struct local_t {
+        pending_t p[mem::nstages];
+        bool registered; // flusher of the thread exists
+        bool exited;     // flusher was destroyed -> not batched anymore
+    };
+    thread_local local_t tls_local {};
+
+    void raise_peak(std::atomic<std::int64_t> &peak, std::int64_t v)
+    {
+        std::int64_t p = peak.load(std::memory_order_relaxed);
+        while (v > p && !peak.compare_exchange_weak(p, v, std::memory_order_relaxed))
+            ;
+    }
+
+    void apply(shared_t &sh, const pending_t &p)
+    {
+        const std::int64_t cur = sh.current.fetch_add(p.delta, std::memory_order_relaxed) + p.delta;
+        raise_peak(sh.peak, cur);
+        sh.allocs.fetch_add(p.allocs, std::memory_order_relaxed);
+        sh.frees.fetch_add(p.frees, std::memory_order_relaxed);
+        sh.bytes.fetch_add(p.bytes, std::memory_order_relaxed);
+    }
+
+    void flush(std::size_t s, pending_t &p)
+    {
+        apply(shared[s], p);
+        apply(shared[mem::nstages], p);
+        p = {};
+    }
+
+    struct flusher_t {
+        ~flusher_t() {
+            for (std::size_t s = 0; s < mem::nstages; s++)
+                flush(s, tls_local.p[s]);
+            tls_local.exited = true;
+        }
+    };
+    thread_local flusher_t tls_flusher;
+
+    void count(std::size_t s, std::int64_t delta)
+    {
+        if (tls_local.exited) {
+            pending_t p { delta, (delta >= 0) ? 1u : 0u, (delta < 0) ? 1u : 0u,
+                          static_cast<std::uint64_t>((delta >= 0) ? delta : 0) };
+            flush(s, p);
+            return;
+        }
+        if (!tls_local.registered) {
+            tls_local.registered = true;
+            (void)&tls_flusher; // NOTE: registers the destructor of the flusher (by calloc, not new)
+        }
+        pending_t &p = tls_local.p[s];
+        p.delta += delta;
+        if (delta >= 0) {
+            p.allocs++;
+            p.bytes += static_cast<std::uint64_t>(delta);
+        } else {
+            p.frees++;
+        }
+        if (p.delta >= flush_bytes || p.delta <= -flush_bytes || p.allocs + p.frees >= flush_ops)
+            flush(s, p);
+    }
+
+}
+
+bool mem::enabled()
+{
+    return hooked.load(std::memory_order_relaxed);
+}
+
+void mem::detail::install() noexcept
+{
+    hooked.store(true, std::memory_order_relaxed);
+}
+
+void mem::detail::account(std::uint8_t stage, std::int64_t delta) noexcept
+{
+    count(stage, delta);
+}
+
+const char *mem::stage_name(mem::stage_t s)
+{
+    switch (s) {
+    case stage_t::OTHER:   return "other";
+    case stage_t::LOAD:    return "load";
+    case stage_t::PARSE:   return "parse";
+    case stage_t::MERGE:   return "merge";
+    case stage_t::ANALYZE: return "analyze";
+    case stage_t::FILTER:  return "filter";
+    case stage_t::EXPORT:  return "export";
+    }
+    return "?";
+}
+
+mem::stage_t mem::set_stage(mem::stage_t s)
+{
+    const stage_t prev = tls_stage;
+    tls_stage = s;
+    return prev;
+}
+
+mem::stage_t mem::stage()
+{
+    return tls_stage;
+}
+
+/**
+ * counters of the stages (batches pending in the other threads are not included)
+ */
+mem::snapshot_t mem::snapshot()
+{
+    mem::snapshot_t snap {};
+    if (!tls_local.exited)
+        for (std::size_t s = 0; s < mem::nstages; s++)
+            flush(s, tls_local.p[s]);
+    auto load = [](const shared_t &sh) {
+        mem::counters_t c;
+        c.current = sh.current.load(std::memory_order_relaxed);
+        c.peak    = sh.peak.load(std::memory_order_relaxed);
+        c.allocs  = sh.allocs.load(std::memory_order_relaxed);
+        c.frees   = sh.frees.load(std::memory_order_relaxed);
+        c.bytes   = sh.bytes.load(std::memory_order_relaxed);
+        return c;
+    };
+    for (std::size_t s = 0; s < mem::nstages; s++)
+        snap.stages[s] = load(shared[s]);
+    snap.total = load(shared[mem::nstages]);
+    return snap;
+}
+
+std::string mem::human(std::int64_t bytes)
+{
+    const char *sign = (bytes < 0) ? "-" : "";
+    const double b = static_cast<double>((bytes < 0) ? -bytes : bytes);
+    if (b < 1024)
+        return fmt::format("{}{} B", sign, b);
+    if (b < 1024 * 1024)
+        return fmt::format("{}{:.1f} KiB", sign, b / 1024);
+    if (b < 1024.0 * 1024 * 1024)
+        return fmt::format("{}{:.1f} MiB", sign, b / (1024 * 1024));
+    return fmt::format("{}{:.2f} GiB", sign, b / (1024.0 * 1024 * 1024));
+}
+
+/**
+ * table of the stages: live & peak bytes, allocations, frees & all allocated bytes
+ */
+std::string mem::report(const mem::snapshot_t &snap)
+{
+    if (!mem::enabled())
+        return "heap accounting is off (build with -DATTILA_MEMSTATS=ON, memhooks.cpp)\n";
+    std::string out { fmt::format("{:<8} {:>12} {:>12} {:>10} {:>10} {:>12}\n",
+                                  "stage", "current", "peak", "allocs", "frees", "allocated") };
+    auto row = [&](const char *name, const mem::counters_t &c) {
+        out += fmt::format("{:<8} {:>12} {:>12} {:>10} {:>10} {:>12}\n", name, mem::human(c.current),
+                           mem::human(c.peak), c.allocs, c.frees, mem::human(static_cast<std::int64_t>(c.bytes)));
+    };
+    for (std::size_t s = 0; s < mem::nstages; s++)
+        row(mem::stage_name(static_cast<stage_t>(s)), snap.stages[s]);
+    row("total", snap.total);
+    return out;
+}
@@ -0,0 +1,65 @@
+#ifndef MEM_HPP
+#define MEM_HPP
+
+#include <array>
+#include <cstddef> // size_t
+#include <cstdint> // int64_t, uint64_t, uint8_t
+#include <string>
+
+namespace mem
+{
+    /**
+     * heap accounting per pipeline stage (hooks are in memhooks.cpp, linked into the app by ATTILA_MEMSTATS):
+     * global operator new/delete count bytes & allocations of the stage of the allocating thread
+     * (set by mem::scope_t), memory is returned to the same stage wherever it is freed.
+     * counters are kept per thread & flushed into the shared totals in small batches
+     * -> current & peak bytes are exact up to a batch (64 KiB) per thread & stage.
+     * NOTE: Qt containers (QString) allocate by malloc() -> not counted by the hooks
+     */
+    enum class stage_t : std::uint8_t { OTHER, LOAD, PARSE, MERGE, ANALYZE, FILTER, EXPORT };
+    constexpr std::size_t nstages { 7 };
+
+    struct counters_t {
+        std::int64_t  current {0}; // live bytes allocated in the stage
+        std::int64_t  peak    {0};
+        std::uint64_t allocs  {0};
+        std::uint64_t frees   {0};
+        std::uint64_t bytes   {0}; // all bytes ever allocated in the stage
+    };
+
+    struct snapshot_t {
+        std::array<mem::counters_t, nstages> stages {};
+        mem::counters_t total {};
+    };
+
+    bool enabled(); // the counting hooks are linked in
+    const char *stage_name(mem::stage_t s);
+    mem::stage_t set_stage(mem::stage_t s); // returns the previous stage of the calling thread
+    mem::stage_t stage();                   // of the calling thread
+    mem::snapshot_t snapshot();
+
+    std::string human(std::int64_t bytes);
+    std::string report(const mem::snapshot_t &snap);
+
+    namespace detail
+    {
+        // called by the hooks of memhooks.cpp
+        void install() noexcept;
+        void account(std::uint8_t stage, std::int64_t delta) noexcept;
+    }
+
+    /**
+     * attribute allocations of the calling thread to the stage until the end of the scope
+     */
+    class scope_t {
+    public:
+        explicit scope_t(mem::stage_t s) : prev(mem::set_stage(s)) {}
+        ~scope_t() { mem::set_stage(prev); }
+        scope_t(const scope_t &) = delete;
+        scope_t &operator=(const scope_t &) = delete;
+    private:
+        mem::stage_t prev;
+    };
+}
+
+#endif // MEM_HPP
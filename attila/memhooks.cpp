@@ -0,0 +1,80 @@
+#include <cstddef> // size_t, max_align_t
+#include <cstdint> // int64_t, uint64_t, uint32_t, uint8_t, uintptr_t
+#include <cstdlib> // malloc, free
+#include <new>     // bad_alloc, nothrow_t, align_val_t
+
+#include "mem.hpp"
+
+/**
+ * replacement of the global operator new/delete counting the heap per stage (see mem.hpp),
+ * linked into the attila executable only (ATTILA_MEMSTATS) -> programs embedding attila_core keep their allocator
+ */
+namespace
+{
+    // placed right before the returned pointer
+    struct alignas(alignof(std::max_align_t)) header_t {
+        std::uint64_t size;
+        std::uint32_t offset; // of the returned pointer from the malloc() block
+        std::uint8_t  stage;
+    };
+
+    void *hook_alloc(std::size_t size, std::size_t align, bool nothrow)
+    {
+        if (align < alignof(std::max_align_t))
+            align = alignof(std::max_align_t);
+        const std::size_t extra = sizeof(header_t) + ((align > alignof(std::max_align_t)) ? align : 0);
+        void *raw = std::malloc(size + extra);
+        if (!raw) {
+            if (nothrow)
+                return nullptr;
+            throw std::bad_alloc();
+        }
+        std::uintptr_t user = reinterpret_cast<std::uintptr_t>(raw) + sizeof(header_t);
+        user = (user + align - 1) & ~static_cast<std::uintptr_t>(align - 1);
+        header_t *h = reinterpret_cast<header_t *>(user) - 1;
+        h->size   = size;
+        h->offset = static_cast<std::uint32_t>(user - reinterpret_cast<std::uintptr_t>(raw));
+        h->stage  = static_cast<std::uint8_t>(mem::stage());
+        mem::detail::account(h->stage, static_cast<std::int64_t>(size));
+        return reinterpret_cast<void *>(user);
+    }
+
+    void hook_free(void *ptr) noexcept
+    {
+        if (!ptr)
+            return;
+        const header_t *h = static_cast<const header_t *>(ptr) - 1;
+        mem::detail::account(h->stage, -static_cast<std::int64_t>(h->size));
+        std::free(static_cast<char *>(ptr) - h->offset);
+    }
+
+    [[maybe_unused]] const bool installed = (mem::detail::install(), true);
+}
+
+void *operator new(std::size_t n) { return hook_alloc(n, 0, false); }
+void *operator new[](std::size_t n) { return hook_alloc(n, 0, false); }
+void *operator new(std::size_t n, const std::nothrow_t &) noexcept { return hook_alloc(n, 0, true); }
+void *operator new[](std::size_t n, const std::nothrow_t &) noexcept { return hook_alloc(n, 0, true); }
+void *operator new(std::size_t n, std::align_val_t a) { return hook_alloc(n, static_cast<std::size_t>(a), false); }
+void *operator new[](std::size_t n, std::align_val_t a) { return hook_alloc(n, static_cast<std::size_t>(a), false); }
+void *operator new(std::size_t n, std::align_val_t a, const std::nothrow_t &) noexcept
+{
+    return hook_alloc(n, static_cast<std::size_t>(a), true);
+}
+void *operator new[](std::size_t n, std::align_val_t a, const std::nothrow_t &) noexcept
+{
+    return hook_alloc(n, static_cast<std::size_t>(a), true);
+}
+
+void operator delete(void *p) noexcept { hook_free(p); }
+void operator delete[](void *p) noexcept { hook_free(p); }
+void operator delete(void *p, std::size_t) noexcept { hook_free(p); }
+void operator delete[](void *p, std::size_t) noexcept { hook_free(p); }
+void operator delete(void *p, std::align_val_t) noexcept { hook_free(p); }
+void operator delete[](void *p, std::align_val_t) noexcept { hook_free(p); }
+void operator delete(void *p, std::size_t, std::align_val_t) noexcept { hook_free(p); }
+void operator delete[](void *p, std::size_t, std::align_val_t) noexcept { hook_free(p); }
+void operator delete(void *p, const std::nothrow_t &) noexcept { hook_free(p); }
+void operator delete[](void *p, const std::nothrow_t &) noexcept { hook_free(p); }
+void operator delete(void *p, std::align_val_t, const std::nothrow_t &) noexcept { hook_free(p); }
+void operator delete[](void *p, std::align_val_t, const std::nothrow_t &) noexcept { hook_free(p); }
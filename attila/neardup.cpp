@@ -0,0 +1,173 @@
+#include <algorithm> // sort, unique, min
+#include <array>
+#include <cctype>    // tolower
+#include <cstddef>   // size_t
+#include <cstdint>   // uint64_t
+#include <limits>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "neardup.hpp"
+#include "structs.hpp" // ss namespace with struct defs
+
+namespace
+{
+    constexpr std::size_t nhashes    { neardup::bands * neardup::rows };
+    constexpr std::size_t bucket_cap { 64 }; // member of the bucket is compared with at most this many previous ones
+
+    using words_t = std::vector<std::string>;
+    using signature_t = std::array<std::uint64_t, nhashes>;
+
+    // sorted unique words of the task in lower case
+    words_t normalized(const ss::task_t &t)
+    {
+        words_t words;
+        words.reserve(t.words.size());
+        for (const auto &w : t.words) {
+            if (w.empty())
+                continue;
+            std::string lw(w);
+            for (char &c : lw)
+                c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+            words.push_back(std::move(lw));
+        }
+        std::sort(words.begin(), words.end());
+        words.erase(std::unique(words.begin(), words.end()), words.end());
+        return words;
+    }
+
+    std::uint64_t fnv1a(std::string_view s)
+    {
+        std::uint64_t h { 14695981039346656037ull };
+        for (const char c : s) {
+            h ^= static_cast<unsigned char>(c);
+            h *= 1099511628211ull;
+        }
+        return h;
+    }
+
+    // splitmix64 finalizer -> i-th hash function of the word is mix(word hash + i-th seed)
+    std::uint64_t mix(std::uint64_t x)
+    {
+        x ^= x >> 30;
+        x *= 0xbf58476d1ce4e5b9ull;
+        x ^= x >> 27;
+        x *= 0x94d049bb133111ebull;
+        x ^= x >> 31;
+        return x;
+    }
+
+    signature_t minhash(const words_t &words)
+    {
+        signature_t sig;
+        sig.fill(std::numeric_limits<std::uint64_t>::max());
+        for (const auto &w : words) {
+            const std::uint64_t h = fnv1a(w);
+            for (std::size_t i = 0; i < nhashes; i++)
+                sig[i] = std::min(sig[i], mix(h + 0x9e3779b97f4a7c15ull * (i + 1)));
+        }
+        return sig;
+    }
+
+    std::uint64_t band_key(const signature_t &sig, std::size_t band)
+    {
+        std::uint64_t h = mix(band + 1);
+        for (std::size_t r = 0; r < neardup::rows; r++)
+            h = mix(h ^ sig[band * neardup::rows + r]);
+        return h;
+    }
+
+    // exact Jaccard similarity of the sorted unique words
+    double jaccard(const words_t &a, const words_t &b)
+    {
+        std::size_t common {0};
+        for (std::size_t i = 0, j = 0; i < a.size() && j < b.size();) {
+            if (a[i] < b[j]) {
+                i++;
+            } else if (b[j] < a[i]) {
+                j++;
+            } else {
+                common++;
+                i++;
+                j++;
+            }
+        }
+        const std::size_t total = a.size() + b.size() - common;
+        return (total) ? static_cast<double>(common) / total : 0.0;
+    }
+
+    class dsu_t {
+    public:
+        explicit dsu_t(std::size_t n) : parent(n) {
+            for (std::size_t i = 0; i < n; i++)
+                parent[i] = i;
+        }
+        std::size_t find(std::size_t i) {
+            while (parent[i] != i)
+                i = parent[i] = parent[parent[i]]; // path halving
+            return i;
+        }
+        void unite(std::size_t a, std::size_t b) {
+            a = find(a);
+            b = find(b);
+            if (a != b)
+                parent[std::max(a, b)] = std::min(a, b);
+        }
+    private:
+        std::vector<std::size_t> parent;
+    };
+}
+
+std::vector<std::size_t> neardup::clusters(const ss::vtasks_t &vtt, double threshold)
+{
+    // the same words -> the same set (tasks without words are kept apart by their text)
+    std::unordered_map<std::string, std::size_t> uniq;
+    std::vector<words_t> sets;
+    std::vector<std::size_t> set_of(vtt.size());
+    std::vector<std::size_t> first; // first task of each set
+    for (std::size_t i = 0; i < vtt.size(); i++) {
+        words_t words = normalized(vtt[i]);
+        std::string key;
+        for (const auto &w : words) {
+            key += w;
+            key += '\x1f';
+        }
+        if (words.empty())
+            key = '\x1e' + vtt[i].text;
+        auto [it, inserted] = uniq.try_emplace(std::move(key), sets.size());
+        if (inserted) {
+            sets.push_back(std::move(words));
+            first.push_back(i);
+        }
+        set_of[i] = it->second;
+    }
+
+    // candidate pairs of the sets from the LSH buckets, verified by the exact similarity
+    dsu_t dsu(sets.size());
+    std::unordered_map<std::uint64_t, std::vector<std::size_t>> buckets;
+    for (std::size_t s = 0; s < sets.size(); s++) {
+        if (sets[s].empty())
+            continue;
+        const signature_t sig = minhash(sets[s]);
+        for (std::size_t b = 0; b < neardup::bands; b++)
+            buckets[band_key(sig, b)].push_back(s);
+    }
+    for (const auto &[key, members] : buckets) {
+        for (std::size_t i = 1; i < members.size(); i++) {
+            const std::size_t beg = (i > bucket_cap) ? i - bucket_cap : 0;
+            for (std::size_t j = beg; j < i; j++) {
+                const std::size_t a = members[j], b = members[i];
+                if (dsu.find(a) != dsu.find(b) && jaccard(sets[a], sets[b]) >= threshold)
+                    dsu.unite(a, b);
+            }
+        }
+    }
+
+    // NOTE: sets are numbered in the order of their first tasks -> root is the earliest set
+    std::vector<std::size_t> out(vtt.size());
+    for (std::size_t i = 0; i < vtt.size(); i++)
+        out[i] = first[dsu.find(set_of[i])];
+    return out;
+}
@@ -0,0 +1,28 @@
+#ifndef NEARDUP_HPP
+#define NEARDUP_HPP
+
+#include <cstddef> // size_t
+#include <vector>
+
+#include "structs.hpp" // ss namespace with struct defs
+
+namespace neardup
+{
+    /**
+     * near-duplicate tasks ("fix lsp hover" ~ "Fix LSP hover.") by MinHash & LSH:
+     * - words of the task (lower case) -> MinHash signature of `bands * rows` hashes
+     * - signatures are bucketed band by band, tasks sharing a bucket are the candidate pairs
+     * - candidates with Jaccard similarity of their words >= threshold are clustered (union-find)
+     * -> roughly linear in the number of tasks instead of comparing all pairs.
+     * tasks with the same set of words are clustered without hashing.
+     */
+    constexpr std::size_t bands { 12 };
+    constexpr std::size_t rows  { 3 };  // ~0.38 Jaccard similarity -> 50 % chance to be a candidate
+
+    /**
+     * cluster of every task: index of the first task of its cluster
+     */
+    std::vector<std::size_t> clusters(const ss::vtasks_t &vtt, double threshold = 0.6);
+}
+
+#endif // NEARDUP_HPP
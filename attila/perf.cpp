@@ -0,0 +1,327 @@
+#include <algorithm> // min
+#include <chrono>
+#include <cstdint>   // uint64_t
+#include <cstdlib>   // setenv
+#include <filesystem>
+#include <fstream>
+#include <iostream>  // cout, cerr
+#include <limits>
+#include <map>
+#include <random>    // mt19937_64
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h> // getrusage
+#endif
+
+#include <fmt/core.h>
+
+#include "perf.hpp"
+#include "attila.hpp"
+#include "cal.hpp"     // ISO week calendar
+#include "mem.hpp"     // heap accounting per stage
+#include "query.hpp"   // query namespace
+#include "stats.hpp"
+#include "structs.hpp" // ss namespace with struct defs
+#include "topk.hpp"    // topk namespace
+
+namespace fs = std::filesystem;
+
+namespace
+{
+    const std::vector<perf::corpus_t> corpora {
+        { "small",   8,  12, 7 },
+        { "medium", 26,  40, 5 },
+        { "large",  52, 120, 3 },
+    };
+
+    struct tolerance_t {
+        double ratio;
+        double slack;
+    };
+
+    // used for the metrics without the tolerance line in the baselines file
+    const std::map<std::string, tolerance_t> default_tolerances {
+        { "time_ms", { 1.5,  2.0 } },
+        { "allocs",  { 1.1, 64.0 } },
+        { "rss_kib", { 1.25, 4096.0 } },
+    };
+
+    constexpr const char *baselines_header {
+        "# performance baselines of the pipeline: attila --batch --perf CORPUS --baselines FILE\n"
+        "# regenerate on the reference machine: attila --batch --perf CORPUS --baselines FILE --update\n"
+        "# tolerance METRIC RATIO SLACK  -> limit = baseline * RATIO + SLACK\n"
+    };
+
+    // date of the n-th day since monday of the first ISO week of 2021
+    std::string day_str(int n)
+    {
+        return cal::date_str(cal::date_of(cal::days_of(cal::isoweek_t { 2021, 1, 1 }) + n));
+    }
+
+    /**
+     * random task text: projects, verb & object, some of them numbered (-> unique texts)
+     * and with varied case/punctuation (-> near-duplicates)
+     */
+    std::string task_text(std::mt19937_64 &rng)
+    {
+        static const char *projects[] { "[nvim]", "[attila]", "[work]", "[home]", "[lsp]", "[qt]" };
+        static const char *verbs[]    { "fix", "refactor", "review", "write", "read", "test", "profile", "merge" };
+        static const char *objects[]  { "lsp hover", "parser", "stats", "mail", "meeting notes",
+                                        "week files", "filter", "heatmap", "export", "docs" };
+        auto pick = [&](std::size_t n) { return static_cast<std::size_t>(rng() % n); };
+        std::string s;
+        if (pick(10) < 7)
+            s += projects[pick(std::size(projects))];
+        if (pick(10) < 2)
+            s += projects[pick(std::size(projects))];
+        if (!s.empty())
+            s += ' ';
+        std::string verb { verbs[pick(std::size(verbs))] };
+        if (pick(10) == 0)
+            verb[0] = static_cast<char>(verb[0] - 'a' + 'A');
+        s += verb + ' ' + objects[pick(std::size(objects))];
+        if (pick(10) < 3)
+            s += fmt::format(" #{}", pick(50));
+        if (pick(10) == 0)
+            s += '.';
+        return s;
+    }
+
+    double peak_rss_kib()
+    {
+#if defined(__unix__) || defined(__APPLE__)
+        struct rusage ru {};
+        if (getrusage(RUSAGE_SELF, &ru) != 0)
+            return 0;
+#if defined(__APPLE__)
+        return static_cast<double>(ru.ru_maxrss) / 1024; // bytes
+#else
+        return static_cast<double>(ru.ru_maxrss);        // KiB
+#endif
+#else
+        return 0; // not available -> not compared
+#endif
+    }
+
+    std::string key_of(const std::string &corpus, const std::string &stage, const std::string &metric)
+    {
+        return corpus + ' ' + stage + ' ' + metric;
+    }
+
+    struct baselines_t {
+        std::map<std::string, tolerance_t> tolerances { default_tolerances };
+        std::map<std::string, double> values; // by key_of()
+    };
+
+    bool read_baselines(const std::string &fpath, baselines_t &b)
+    {
+        std::ifstream ifile(fpath);
+        if (!ifile)
+            return false;
+        std::string line;
+        while (std::getline(ifile, line)) {
+            std::istringstream ls(line);
+            std::string first;
+            if (!(ls >> first) || first[0] == '#')
+                continue;
+            if (first == "tolerance") {
+                std::string metric;
+                tolerance_t t {};
+                if (ls >> metric >> t.ratio >> t.slack)
+                    b.tolerances[metric] = t;
+                continue;
+            }
+            std::string stage, metric;
+            double value {};
+            if (ls >> stage >> metric >> value)
+                b.values[key_of(first, stage, metric)] = value;
+        }
+        return true;
+    }
+
+    /**
+     * replace the baselines of the corpus by the samples, other lines are kept as they are
+     */
+    bool write_baselines(const std::string &fpath, const std::string &corpus,
+                         const std::vector<perf::sample_t> &samples)
+    {
+        std::string out;
+        std::ifstream ifile(fpath);
+        if (ifile) {
+            std::string line;
+            while (std::getline(ifile, line)) {
+                std::istringstream ls(line);
+                std::string first;
+                if ((ls >> first) && first == corpus)
+                    continue;
+                out += line + '\n';
+            }
+            ifile.close();
+        } else {
+            out += baselines_header;
+            for (const auto &[metric, t] : default_tolerances)
+                out += fmt::format("tolerance {} {} {}\n", metric, t.ratio, t.slack);
+        }
+        for (const auto &s : samples)
+            out += fmt::format("{} {} {} {:.3f}\n", corpus, s.stage, s.metric, s.value);
+        std::ofstream ofile(fpath, std::ios::trunc);
+        ofile << out;
+        return static_cast<bool>(ofile);
+    }
+}
+
+bool perf::corpus_of(const std::string &name, perf::corpus_t &c)
+{
+    for (const auto &cc : corpora) {
+        if (cc.name == name) {
+            c = cc;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * week files of the corpus, the same for the same corpus on every platform
+ * (raw mt19937_64 output is specified by the standard, the distributions are not -> not used)
+ */
+void perf::generate(const perf::corpus_t &c, const std::string &dir)
+{
+    fs::create_directories(dir);
+    std::mt19937_64 rng(0x617474696c61ull + static_cast<std::uint64_t>(c.weeks));
+    auto pick = [&](int n) { return static_cast<int>(rng() % static_cast<std::uint64_t>(n)); };
+    const int slot = 18 * 60 / c.per_day; // minutes of the day per task (06:00 - 24:00)
+    for (int w = 0; w < c.weeks; w++) {
+        std::string content;
+        for (int d = 0; d < 7; d++) {
+            const std::string day = day_str(w * 7 + d);
+            content += "# " + day + '\n';
+            for (int i = 0; i < c.per_day; i++) {
+                const int beg = 6 * 60 + i * slot + pick(slot / 3 + 1);
+                const int end = beg + 1 + pick(slot / 2);
+                content += fmt::format("{} {:02}:{:02} - {:02}:{:02} {}\n",
+                                       day, beg / 60, beg % 60, end / 60, end % 60, task_text(rng));
+                if (pick(20) == 0)
+                    content += "free form note line\n";
+            }
+        }
+        std::ofstream ofile(fs::path(dir) / fmt::format("week-{:02}-2021.txt", w + 1), std::ios::binary);
+        ofile << content;
+    }
+}
+
+/**
+ * run the pipeline stages over the corpus in dir (the only task directory of the process)
+ */
+std::vector<perf::sample_t> perf::measure(const perf::corpus_t &c, const std::string &dir)
+{
+    setenv("POMODORO_DIRS", dir.c_str(), 1); // NOTE: task_roots() of the whole process
+    const std::string fr = day_str(0);
+    const std::string to = day_str(c.weeks * 7 - 1);
+
+    std::vector<perf::sample_t> samples;
+    double total_ms {0};
+    // best time of the repetitions, allocations of the first one
+    auto stage = [&](const char *name, auto &&fn) {
+        double best = std::numeric_limits<double>::max();
+        double allocs {0};
+        for (int r = 0; r < c.reps; r++) {
+            const std::uint64_t a0 = mem::snapshot().total.allocs;
+            const auto t0 = std::chrono::steady_clock::now();
+            fn();
+            const auto t1 = std::chrono::steady_clock::now();
+            if (r == 0)
+                allocs = static_cast<double>(mem::snapshot().total.allocs - a0);
+            best = std::min(best, std::chrono::duration<double, std::milli>(t1 - t0).count());
+        }
+        total_ms += best;
+        samples.push_back({ name, "time_ms", best });
+        if (mem::enabled())
+            samples.push_back({ name, "allocs", allocs });
+    };
+
+    std::size_t nfiles {0};
+    std::string content;
+    ss::vtasks_t vtt;
+    std::size_t nmerged {0}, nfiltered {0};
+    stage("catalog", [&]() {
+        nfiles = 0;
+        for (const auto &root : task_roots())
+            nfiles += find_week_files_in_span(root, fr, to).size();
+    });
+    stage("concat", [&]() { content = concat_span(fr, to); });
+    stage("parse", [&]() { vtt = parse_tasks_parallel(content); });
+    stage("merge", [&]() { nmerged = merge_tasks(vtt, content).first.size(); });
+    stage("filter", [&]() {
+        query::filter_t qf("project:nvim duration>3m weekday:mon-fri");
+        nfiltered = filter_tasks(vtt, "lsp|parser").size() + qf.filter(vtt).size();
+    });
+    stage("stats", [&]() {
+        const ss::stats_t st = calculate_stats(vtt);
+        const ss::heatmap_t hm = calculate_heatmap(vtt);
+        const std::string rep = topk::report(vtt, 10);
+        (void)st; (void)hm; (void)rep;
+    });
+    samples.push_back({ "pipeline", "time_ms", total_ms });
+    stage("load", [&]() { (void)load_span(fr, to); });
+    const double rss = peak_rss_kib();
+    if (rss > 0)
+        samples.push_back({ "process", "rss_kib", rss });
+
+    std::cout << fmt::format("perf: {} ({} weeks, {} tasks/day, best of {}): {} files, {} tasks, "
+                             "{} merged, {} filtered\n",
+                             c.name, c.weeks, c.per_day, c.reps, nfiles, vtt.size(), nmerged, nfiltered);
+    return samples;
+}
+
+int perf::run(const std::string &corpus, const std::string &baselines, const std::string &dir, bool update)
+{
+    perf::corpus_t c {};
+    if (!perf::corpus_of(corpus, c)) {
+        std::cerr << "[Error]: unknown perf corpus: '" << corpus << "' (small, medium, large)" << std::endl;
+        return 2;
+    }
+    const std::string cdir = (fs::path(dir) / ("attila-perf-" + c.name)).string();
+    std::error_code ec;
+    fs::remove_all(cdir, ec); // NOTE: only the generated corpus directory
+    perf::generate(c, cdir);
+    const std::vector<perf::sample_t> samples = perf::measure(c, cdir);
+
+    if (update) {
+        if (!write_baselines(baselines, c.name, samples)) {
+            std::cerr << "[Error]: cannot write the baselines file: '" << baselines << "'" << std::endl;
+            return 2;
+        }
+        std::cout << fmt::format("baselines of '{}' updated: {}\n", c.name, baselines);
+        return 0;
+    }
+    baselines_t b;
+    if (!read_baselines(baselines, b)) {
+        std::cerr << "[Error]: cannot read the baselines file: '" << baselines << "'" << std::endl;
+        return 2;
+    }
+    int regressions {0};
+    std::cout << fmt::format("{:<9} {:<8} {:>12} {:>12} {:>12}\n", "stage", "metric", "baseline", "measured", "limit");
+    for (const auto &s : samples) {
+        const auto it = b.values.find(key_of(c.name, s.stage, s.metric));
+        if (it == b.values.end()) {
+            std::cout << fmt::format("{:<9} {:<8} {:>12} {:>12.2f} {:>12}  new\n", s.stage, s.metric, "-", s.value, "-");
+            continue;
+        }
+        const auto tit = b.tolerances.find(s.metric);
+        const tolerance_t t = (tit != b.tolerances.end()) ? tit->second : tolerance_t { 1.0, 0.0 };
+        const double limit = it->second * t.ratio + t.slack;
+        const bool regressed = s.value > limit;
+        regressions += regressed;
+        std::cout << fmt::format("{:<9} {:<8} {:>12.2f} {:>12.2f} {:>12.2f}  {}\n", s.stage, s.metric,
+                                 it->second, s.value, limit, (regressed) ? "REGRESSION" : "ok");
+    }
+    if (regressions) {
+        std::cout << fmt::format("{} regression(s) of '{}' against {}\n", regressions, c.name, baselines);
+        return 1;
+    }
+    return 0;
+}
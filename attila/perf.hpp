@@ -0,0 +1,44 @@
+#ifndef PERF_HPP
+#define PERF_HPP
+
+#include <string>
+#include <vector>
+
+namespace perf
+{
+    /**
+     * performance regression runs of the whole pipeline
+     * (catalog -> concat -> parse -> merge -> filter -> stats, and the concurrent loader)
+     * on a deterministic synthetic corpus. measured per stage: best time of the repetitions
+     * & heap allocations (ATTILA_MEMSTATS builds), per process: peak RSS.
+     * measurements are compared with the baselines file (perf_baselines.txt):
+     *   tolerance METRIC RATIO SLACK   -> limit = baseline * RATIO + SLACK
+     *   CORPUS STAGE METRIC VALUE      -> baseline of the metric
+     * metric above its limit is a regression, metric without baseline is only reported.
+     */
+    struct corpus_t {
+        std::string name;
+        int weeks;   // consecutive ISO weeks of 2021 (week files week-01-2021.txt, ...)
+        int per_day; // tasks per day
+        int reps;    // repetitions of the timed stages
+    };
+
+    struct sample_t {
+        std::string stage;
+        std::string metric; // time_ms, allocs, rss_kib
+        double value;
+    };
+
+    bool corpus_of(const std::string &name, perf::corpus_t &c);
+    void generate(const perf::corpus_t &c, const std::string &dir);
+    std::vector<perf::sample_t> measure(const perf::corpus_t &c, const std::string &dir);
+
+    /**
+     * generate the corpus into dir/attila-perf-NAME, measure it & compare with the baselines
+     * (update: store the measurements as the new baselines of the corpus instead).
+     * returns process exit code: 1 on regression, 2 on bad arguments/files.
+     */
+    int run(const std::string &corpus, const std::string &baselines, const std::string &dir, bool update);
+}
+
+#endif // PERF_HPP
@@ -0,0 +1,695 @@
+#include <algorithm> // search, stable_sort, any_of
+#include <cctype>    // isspace, isdigit
+#include <cstddef>   // size_t
+#include <cstdint>   // int64_t, uint8_t
+#include <string>
+#include <string_view>
+#include <utility>   // move
+#include <vector>
+
+#include "query.hpp"
+#include "mem.hpp"   // heap accounting per stage
+#include "exec.hpp"  // shared thread pool
+
+using field_t = query::field_t;
+using op_t    = query::op_t;
+using node_t  = query::node_t;
+using term_t  = query::term_t;
+
+namespace
+{
+    constexpr std::size_t sample_size { 256 };   // tasks sampled to estimate the selectivity
+    constexpr std::size_t par_min     { 10000 }; // filter smaller vectors in one thread
+
+    // estimated evaluation cost of the term per task
+    constexpr int cost_num   {   1 }; // integer comparison of the parsed field
+    constexpr int cost_proj  {   4 };
+    constexpr int cost_text  {   8 };
+    constexpr int cost_dfa   {  16 };
+    constexpr int cost_regex { 128 };
+
+    struct token_t {
+        enum kind_t { WORD, LPAR, RPAR, OR, AND, NOT, END } kind;
+        std::string text {};
+        bool quoted { false };
+    };
+
+    // cancellation token is checked once per 4096 tasks
+    inline bool canceled(const std::atomic<bool> *cancel, std::size_t i)
+    {
+        return cancel && (i & 0xfff) == 0 && cancel->load(std::memory_order_relaxed);
+    }
+
+    inline char lower(char c)
+    {
+        return (c >= 'A' && c <= 'Z') ? static_cast<char>(c + ('a' - 'A')) : c;
+    }
+
+    std::string lower(std::string_view s)
+    {
+        std::string out(s);
+        for (char &c : out)
+            c = lower(c);
+        return out;
+    }
+
+    bool is_space(char c) { return std::isspace(static_cast<unsigned char>(c)); }
+    bool is_digit(char c) { return std::isdigit(static_cast<unsigned char>(c)); }
+
+    bool tokenize(const std::string &q, std::vector<token_t> &tokens, std::string &err)
+    {
+        std::size_t i {0};
+        while (i < q.size()) {
+            const char c = q[i];
+            if (is_space(c)) { i++; continue; }
+            if (c == '(') { tokens.push_back({ token_t::LPAR }); i++; continue; }
+            if (c == ')') { tokens.push_back({ token_t::RPAR }); i++; continue; }
+            if (c == '|') { tokens.push_back({ token_t::OR });   i++; continue; }
+            if (c == '&') { tokens.push_back({ token_t::AND });  i++; continue; }
+            if ((c == '-' || c == '!') && i + 1 < q.size() && !is_space(q[i + 1]) && q[i + 1] != ')') {
+                tokens.push_back({ token_t::NOT });
+                i++;
+                continue;
+            }
+            token_t w { token_t::WORD };
+            bool in_quotes = false;
+            for (; i < q.size(); i++) {
+                const char ch = q[i];
+                if (ch == '"') {
+                    in_quotes = !in_quotes;
+                    w.quoted = true;
+                    continue;
+                }
+                if (!in_quotes && (is_space(ch) || ch == '(' || ch == ')'))
+                    break;
+                w.text += ch;
+            }
+            if (in_quotes) {
+                err = "unterminated quote";
+                return false;
+            }
+            const std::string kw = lower(w.text);
+            if (!w.quoted && (kw == "or" || kw == "and" || kw == "not"))
+                w.kind = (kw == "or") ? token_t::OR : (kw == "and") ? token_t::AND : token_t::NOT;
+            tokens.push_back(std::move(w));
+        }
+        tokens.push_back({ token_t::END });
+        return true;
+    }
+
+    bool field_of(const std::string &name, field_t &f)
+    {
+        static const std::pair<const char*, field_t> aliases[] {
+            { "text", field_t::TEXT },         { "t",    field_t::TEXT },
+            { "project", field_t::PROJECT },   { "proj", field_t::PROJECT }, { "p", field_t::PROJECT },
+            { "duration", field_t::DURATION }, { "dur",  field_t::DURATION }, { "d", field_t::DURATION },
+            { "date", field_t::DATE },
+            { "time", field_t::TIME },         { "tod",  field_t::TIME },
+            { "weekday", field_t::WEEKDAY },   { "wd",   field_t::WEEKDAY }, { "day", field_t::WEEKDAY },
+            { "root", field_t::ROOT },
+        };
+        for (const auto &[alias, field] : aliases) {
+            if (name == alias) {
+                f = field;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // parse unsigned integer of the whole string
+    bool parse_uint(std::string_view s, std::int64_t &v)
+    {
+        if (s.empty() || s.size() > 12)
+            return false;
+        v = 0;
+        for (const char c : s) {
+            if (!is_digit(c))
+                return false;
+            v = v * 10 + (c - '0');
+        }
+        return true;
+    }
+
+    // 1h30m, 90m, 45s, 1:30 (h:mm), 30 (minutes) -> seconds
+    bool parse_duration(std::string_view s, std::int64_t &lo, std::int64_t &hi)
+    {
+        std::int64_t sec {0};
+        const std::size_t colon = s.find(':');
+        if (colon != std::string_view::npos) {
+            std::int64_t h, m;
+            if (!parse_uint(s.substr(0, colon), h) || !parse_uint(s.substr(colon + 1), m))
+                return false;
+            sec = h * 3600 + m * 60;
+        } else {
+            if (s.empty())
+                return false;
+            std::size_t i {0};
+            while (i < s.size()) {
+                const std::size_t beg = i;
+                while (i < s.size() && is_digit(s[i]))
+                    i++;
+                std::int64_t n;
+                if (!parse_uint(s.substr(beg, i - beg), n))
+                    return false;
+                const char unit = (i < s.size()) ? lower(s[i++]) : 'm'; // bare number -> minutes
+                switch (unit) {
+                case 'h': sec += n * 3600; break;
+                case 'm': sec += n * 60;   break;
+                case 's': sec += n;        break;
+                default: return false;
+                }
+            }
+        }
+        lo = hi = sec;
+        return true;
+    }
+
+    // YYYY-MM-DD, YYYY-MM, YYYY -> YYYYMMDD interval
+    bool parse_date(std::string_view s, std::int64_t &lo, std::int64_t &hi)
+    {
+        std::int64_t y, m {0}, d {0};
+        if (s.size() < 4 || !parse_uint(s.substr(0, 4), y))
+            return false;
+        if (s.size() == 4) {
+            lo = y * 10000 + 101;
+            hi = y * 10000 + 1231;
+            return true;
+        }
+        if (s.size() < 7 || s[4] != '-' || !parse_uint(s.substr(5, 2), m) || m < 1 || m > 12)
+            return false;
+        if (s.size() == 7) {
+            lo = y * 10000 + m * 100 + 1;
+            hi = y * 10000 + m * 100 + 31;
+            return true;
+        }
+        if (s.size() != 10 || s[7] != '-' || !parse_uint(s.substr(8, 2), d) || d < 1 || d > 31)
+            return false;
+        lo = hi = y * 10000 + m * 100 + d;
+        return true;
+    }
+
+    // HH:MM, HH -> minutes of the day interval
+    bool parse_time(std::string_view s, std::int64_t &lo, std::int64_t &hi)
+    {
+        std::int64_t h, m {0};
+        const std::size_t colon = s.find(':');
+        if (!parse_uint(s.substr(0, colon), h) || h > 23)
+            return false;
+        if (colon == std::string_view::npos) {
+            lo = h * 60;
+            hi = h * 60 + 59;
+            return true;
+        }
+        if (!parse_uint(s.substr(colon + 1), m) || m > 59)
+            return false;
+        lo = hi = h * 60 + m;
+        return true;
+    }
+
+    bool parse_root(std::string_view s, std::int64_t &lo, std::int64_t &hi)
+    {
+        if (!parse_uint(s, lo))
+            return false;
+        hi = lo;
+        return true;
+    }
+
+    // mon, tu, fri-mon, sat,sun, weekend, workdays -> mask (bit 0 is Monday)
+    bool parse_wdays(std::string_view s, std::uint8_t &mask)
+    {
+        static constexpr const char *names[] { "mon", "tue", "wed", "thu", "fri", "sat", "sun" };
+        auto day = [](const std::string &w, int &d) {
+            for (d = 0; d < 7; d++)
+                if (w.size() >= 2 && std::string_view(names[d]).substr(0, w.size()) == w)
+                    return true;
+            return false;
+        };
+        mask = 0;
+        const std::string l = lower(s);
+        std::size_t beg {0};
+        while (beg <= l.size()) {
+            std::size_t end = l.find(',', beg);
+            if (end == std::string::npos)
+                end = l.size();
+            const std::string item = l.substr(beg, end - beg);
+            const std::size_t dash = item.find('-');
+            int fr, to;
+            if (item == "weekend" || item == "weekends") {
+                mask |= 0b1100000;
+            } else if (item == "workday" || item == "workdays") {
+                mask |= 0b0011111;
+            } else if (dash != std::string::npos) {
+                if (!day(item.substr(0, dash), fr) || !day(item.substr(dash + 1), to))
+                    return false;
+                for (int d = fr; ; d = (d + 1) % 7) { // NOTE: wraps around: fri-mon
+                    mask |= static_cast<std::uint8_t>(1u << d);
+                    if (d == to)
+                        break;
+                }
+            } else {
+                if (!day(item, fr))
+                    return false;
+                mask |= static_cast<std::uint8_t>(1u << fr);
+            }
+            beg = end + 1;
+        }
+        return mask != 0;
+    }
+
+    bool parse_interval(field_t f, std::string_view s, std::int64_t &lo, std::int64_t &hi)
+    {
+        switch (f) {
+        case field_t::DURATION: return parse_duration(s, lo, hi);
+        case field_t::DATE:     return parse_date(s, lo, hi);
+        case field_t::TIME:     return parse_time(s, lo, hi);
+        case field_t::ROOT:     return parse_root(s, lo, hi);
+        default:                return false;
+        }
+    }
+
+    /**
+     * numeric value: single value or the range 'a..b' (also 'a-b' for the time of the day)
+     */
+    bool parse_numeric(term_t &m, std::string_view v, std::string &err)
+    {
+        std::int64_t lo, hi, lo2, hi2;
+        std::size_t sep = v.find("..");
+        std::size_t sep_len = 2;
+        if (sep == std::string_view::npos && m.field == field_t::TIME) {
+            sep = v.find('-');
+            sep_len = 1;
+        }
+        if (sep != std::string_view::npos) {
+            if (m.op != op_t::HAS && m.op != op_t::EQ) {
+                err = "range is allowed only with ':' or '='";
+                return false;
+            }
+            if (!parse_interval(m.field, v.substr(0, sep), lo, hi)
+                || !parse_interval(m.field, v.substr(sep + sep_len), lo2, hi2)) {
+                err = "invalid range: '" + std::string(v) + "'";
+                return false;
+            }
+            m.lo = lo;
+            m.hi = hi2;
+            return true;
+        }
+        if (!parse_interval(m.field, v, lo, hi)) {
+            err = "invalid value: '" + std::string(v) + "'";
+            return false;
+        }
+        m.lo = lo;
+        m.hi = hi;
+        return true;
+    }
+
+    bool make_pattern(term_t &m, const std::string &pattern, std::string &err)
+    {
+        m.dm.emplace(pattern, true);
+        if (m.dm->supported())
+            return true;
+        m.dm.reset();
+        try {
+            m.re.emplace(pattern, std::regex::icase | std::regex::optimize);
+        } catch (const std::regex_error &) {
+            err = "invalid regex: '" + pattern + "'";
+            return false;
+        }
+        return true;
+    }
+
+    int term_cost(const term_t &m)
+    {
+        if (m.op == op_t::MATCH)
+            return (m.dm) ? cost_dfa : cost_regex;
+        switch (m.field) {
+        case field_t::TEXT:    return cost_text;
+        case field_t::PROJECT: return cost_proj;
+        default:               return cost_num;
+        }
+    }
+
+    /**
+     * field term 'name op value' or bare word (substring of the task text)
+     */
+    bool make_term(const token_t &tok, node_t &n, std::string &err)
+    {
+        n.kind = node_t::TERM;
+        term_t &m = n.term;
+        const std::string &w = tok.text;
+        const std::size_t opos = w.find_first_of(":~<>=");
+        field_t f;
+        if (opos == std::string::npos || opos == 0 || !field_of(lower(w.substr(0, opos)), f)) {
+            m.field = field_t::TEXT;
+            m.op = op_t::HAS;
+            m.str = lower(w);
+            n.cost = term_cost(m);
+            return true;
+        }
+        m.field = f;
+        std::size_t vpos = opos + 1;
+        switch (w[opos]) {
+        case ':': m.op = op_t::HAS;   break;
+        case '~': m.op = op_t::MATCH; break;
+        case '=': m.op = op_t::EQ;    break;
+        case '<': m.op = op_t::LT;    break;
+        case '>': m.op = op_t::GT;    break;
+        }
+        if (vpos < w.size() && w[vpos] == '=' && (m.op == op_t::LT || m.op == op_t::GT)) {
+            m.op = (m.op == op_t::LT) ? op_t::LE : op_t::GE;
+            vpos++;
+        }
+        const std::string v = w.substr(vpos);
+        if (v.empty()) {
+            err = "missing value of '" + w + "'";
+            return false;
+        }
+
+        switch (f) {
+        case field_t::TEXT:
+        case field_t::PROJECT:
+            if (m.op == op_t::MATCH) {
+                if (!make_pattern(m, v, err))
+                    return false;
+            } else if (m.op == op_t::HAS || m.op == op_t::EQ) {
+                m.op = op_t::HAS;
+                m.str = lower(v);
+            } else {
+                err = "text & project support only ':' and '~'";
+                return false;
+            }
+            break;
+        case field_t::WEEKDAY:
+            if (m.op != op_t::HAS && m.op != op_t::EQ) {
+                err = "weekday supports only ':'";
+                return false;
+            }
+            if (!parse_wdays(v, m.wdays)) {
+                err = "invalid weekday: '" + v + "'";
+                return false;
+            }
+            break;
+        default:
+            if (m.op == op_t::MATCH) {
+                err = "'~' is supported only by text & project";
+                return false;
+            }
+            if (!parse_numeric(m, v, err))
+                return false;
+            break;
+        }
+        n.cost = term_cost(m);
+        return true;
+    }
+
+    /**
+     * recursive descent parser:
+     *   or    := and ( ('or' | '|') and )*
+     *   and   := unary ( ['and' | '&'] unary )*
+     *   unary := ('not' | '-' | '!') unary | '(' or ')' | term
+     */
+    class parser_t {
+    public:
+        parser_t(const std::vector<token_t> &tokens, std::string &err) : tokens(tokens), err(err) {}
+
+        bool parse(node_t &n) {
+            if (!parse_or(n, false))
+                return false;
+            if (tokens[pos].kind != token_t::END) {
+                err = "unexpected ')'";
+                return false;
+            }
+            return true;
+        }
+
+    private:
+        token_t::kind_t peek() const { return tokens[pos].kind; }
+
+        // single child AND/OR -> the child itself
+        static void flatten(node_t &n) {
+            if ((n.kind == node_t::AND || n.kind == node_t::OR) && n.kids.size() == 1) {
+                node_t kid = std::move(n.kids[0]);
+                n = std::move(kid);
+            }
+        }
+
+        static void sum_cost(node_t &n) {
+            n.cost = 0;
+            for (const auto &k : n.kids)
+                n.cost += k.cost;
+        }
+
+        // empty operand matches every task -> allowed only as the whole query (empty query)
+        static bool empty(const node_t &n) { return n.kind == node_t::AND && n.kids.empty(); }
+
+        bool parse_or(node_t &n, bool nested) {
+            n = node_t { node_t::OR };
+            do {
+                if (!n.kids.empty())
+                    pos++; // 'or' between the operands
+                node_t kid { node_t::AND };
+                if (!parse_and(kid))
+                    return false;
+                n.kids.push_back(std::move(kid));
+            } while (peek() == token_t::OR);
+            if ((nested || n.kids.size() > 1) && std::any_of(n.kids.begin(), n.kids.end(), empty)) {
+                err = "missing term";
+                return false;
+            }
+            sum_cost(n);
+            flatten(n);
+            return true;
+        }
+
+        bool parse_and(node_t &n) {
+            n = node_t { node_t::AND };
+            while (peek() != token_t::OR && peek() != token_t::RPAR && peek() != token_t::END) {
+                if (peek() == token_t::AND) {
+                    pos++;
+                    continue;
+                }
+                node_t kid { node_t::TERM };
+                if (!parse_unary(kid))
+                    return false;
+                n.kids.push_back(std::move(kid));
+            }
+            sum_cost(n);
+            flatten(n);
+            return true;
+        }
+
+        bool parse_unary(node_t &n) {
+            switch (peek()) {
+            case token_t::NOT: {
+                pos++;
+                node_t kid { node_t::TERM };
+                if (!parse_unary(kid))
+                    return false;
+                n = node_t { node_t::NOT };
+                n.kids.push_back(std::move(kid));
+                n.cost = n.kids[0].cost;
+                return true;
+            }
+            case token_t::LPAR:
+                pos++;
+                if (!parse_or(n, true))
+                    return false;
+                if (peek() != token_t::RPAR) {
+                    err = "missing ')'";
+                    return false;
+                }
+                pos++;
+                return true;
+            case token_t::WORD:
+                return make_term(tokens[pos++], n, err);
+            default:
+                err = "missing term";
+                return false;
+            }
+        }
+
+    private:
+        const std::vector<token_t> &tokens;
+        std::string &err;
+        std::size_t pos {0};
+    };
+
+    // case insensitive substring (needle is lowercase)
+    inline bool icontains(std::string_view hay, std::string_view needle)
+    {
+        return std::search(hay.begin(), hay.end(), needle.begin(), needle.end(),
+                           [](char a, char b) { return lower(a) == b; }) != hay.end();
+    }
+
+    inline bool pattern_match(term_t &m, std::string_view s)
+    {
+        if (m.dm)
+            return m.dm->search(s);
+        return std::regex_search(s.begin(), s.end(), *m.re);
+    }
+
+    inline bool numeric_match(const term_t &m, std::int64_t x)
+    {
+        switch (m.op) {
+        case op_t::LT: return x <  m.lo;
+        case op_t::LE: return x <= m.hi;
+        case op_t::GT: return x >  m.hi;
+        case op_t::GE: return x >= m.lo;
+        default:       return m.lo <= x && x <= m.hi;
+        }
+    }
+
+    bool term_match(term_t &m, const ss::task_t &t)
+    {
+        const std::tm &tm = t.hm_t.tm_beg;
+        switch (m.field) {
+        case field_t::TEXT:
+            return (m.op == op_t::MATCH) ? pattern_match(m, t.text) : icontains(t.text, m.str);
+        case field_t::PROJECT:
+            return std::any_of(t.tproj.begin(), t.tproj.end(), [&](const std::string &p) {
+                return (m.op == op_t::MATCH) ? pattern_match(m, p)
+                                             : p.size() == m.str.size() && icontains(p, m.str);
+            });
+        case field_t::DURATION:
+            return numeric_match(m, t.hm_t.diff);
+        case field_t::DATE:
+            return numeric_match(m, (tm.tm_year + 1900) * 10000 + (tm.tm_mon + 1) * 100 + tm.tm_mday);
+        case field_t::TIME:
+            return numeric_match(m, tm.tm_hour * 60 + tm.tm_min);
+        case field_t::WEEKDAY:
+            return (m.wdays >> ((tm.tm_wday + 6) % 7)) & 1u;
+        case field_t::ROOT:
+            return numeric_match(m, t.root);
+        }
+        return false;
+    }
+
+    bool eval(node_t &n, const ss::task_t &t)
+    {
+        switch (n.kind) {
+        case node_t::AND:
+            for (auto &k : n.kids)
+                if (!eval(k, t))
+                    return false;
+            return true;
+        case node_t::OR:
+            for (auto &k : n.kids)
+                if (eval(k, t))
+                    return true;
+            return false;
+        case node_t::NOT:
+            return !eval(n.kids[0], t);
+        case node_t::TERM:
+            return term_match(n.term, t);
+        }
+        return false;
+    }
+
+    /**
+     * order children of AND/OR nodes by the expected cost to decide the node:
+     * AND -> cheap & rejecting most of the tasks first, OR -> cheap & accepting most first.
+     * pass rates are measured on the sample of the filtered tasks. returns pass rate of the node.
+     */
+    double order(node_t &n, const std::vector<const ss::task_t*> &sample)
+    {
+        for (auto &k : n.kids)
+            order(k, sample);
+        if (n.kind == node_t::AND || n.kind == node_t::OR) {
+            std::vector<std::pair<double, std::size_t>> ranks; // rank & index of the child
+            for (std::size_t i = 0; i < n.kids.size(); i++) {
+                std::size_t pass {0};
+                for (const ss::task_t *t : sample)
+                    pass += eval(n.kids[i], *t);
+                const double p = (sample.empty()) ? 0.5 : double(pass) / sample.size();
+                const double decisive = (n.kind == node_t::AND) ? 1.0 - p : p;
+                ranks.push_back({ n.kids[i].cost / (decisive + 1e-3), i });
+            }
+            std::stable_sort(ranks.begin(), ranks.end(),
+                             [](const auto &a, const auto &b) { return a.first < b.first; });
+            std::vector<node_t> kids;
+            kids.reserve(n.kids.size());
+            for (const auto &r : ranks)
+                kids.push_back(std::move(n.kids[r.second]));
+            n.kids = std::move(kids);
+        }
+        std::size_t pass {0};
+        for (const ss::task_t *t : sample)
+            pass += eval(n, *t);
+        return (sample.empty()) ? 0.5 : double(pass) / sample.size();
+    }
+}
+
+query::filter_t::filter_t(const std::string &query)
+{
+    std::vector<token_t> tokens;
+    if (!tokenize(query, tokens, err))
+        return;
+    parser_t parser(tokens, err);
+    node_t n { node_t::AND };
+    if (!parser.parse(n)) {
+        if (err.empty())
+            err = "invalid query";
+        return;
+    }
+    root = std::move(n);
+}
+
+bool query::filter_t::match(const ss::task_t &t)
+{
+    return eval(root, t);
+}
+
+void query::filter_t::optimize(const ss::vtasks_t &vtt)
+{
+    std::vector<const ss::task_t*> sample;
+    const std::size_t step = std::max<std::size_t>(1, vtt.size() / sample_size);
+    for (std::size_t i = 0; i < vtt.size() && sample.size() < sample_size; i += step)
+        sample.push_back(&vtt[i]);
+    order(root, sample);
+}
+
+/**
+ * tasks matching the query (in the original order).
+ * large vectors are filtered by chunks in parallel, each chunk by its own copy of the predicate tree
+ * (regex terms cache DFA states while matching).
+ */
+ss::vtasks_t query::filter_t::filter(const ss::vtasks_t &vtt, const std::atomic<bool> *cancel)
+{
+    const mem::scope_t mscope(mem::stage_t::FILTER);
+    ss::vtasks_t out;
+    if (!ok())
+        return out;
+    optimize(vtt);
+    const std::size_t n = vtt.size();
+    const std::size_t threads_total = exec::workers();
+    if (threads_total < 2 || n < par_min) {
+        for (std::size_t i = 0; i < n; i++) {
+            if (canceled(cancel, i))
+                return out;
+            if (eval(root, vtt[i]))
+                out.push_back(vtt[i]);
+        }
+        return out;
+    }
+    const std::size_t tpc = n / threads_total; // tasks per chunk (last chunk takes the remainder)
+    std::vector<exec::future_t<std::vector<std::size_t>>> futures;
+    for (std::size_t c = 0; c < threads_total; c++) {
+        const std::size_t beg = tpc * c;
+        const std::size_t end = (c + 1 == threads_total) ? n : beg + tpc;
+        futures.push_back(exec::async([&vtt, beg, end, cancel, plan = root]() mutable {
+            const mem::scope_t mscope(mem::stage_t::FILTER);
+            std::vector<std::size_t> hits;
+            for (std::size_t i = beg; i < end; i++) {
+                if (canceled(cancel, i - beg))
+                    break;
+                if (eval(plan, vtt[i]))
+                    hits.push_back(i);
+            }
+            return hits;
+        }));
+    }
+    for (auto &f : futures)
+        for (const std::size_t i : f.get())
+            out.push_back(vtt[i]);
+    return out;
+}
@@ -0,0 +1,71 @@
+#ifndef QUERY_HPP
+#define QUERY_HPP
+
+#include <atomic>  // atomic<bool> cancellation token
+#include <cstdint> // int64_t, uint8_t
+#include <optional>
+#include <regex>
+#include <string>
+#include <vector>
+
+#include "dfa.hpp"     // dfa namespace
+#include "structs.hpp" // ss namespace with struct defs
+
+namespace query
+{
+    /**
+     * structured filter of the parsed tasks, e.g.:
+     *   project:nvim duration>30m weekday:mon-fri text~lsp
+     *   (p:attila | p:nvim) -text:wip date:2022-01 time:09:00-12:00
+     *
+     * fields: text (t), project (p), duration (d), date, time (start time of the day), weekday (wd), root.
+     * operators: ':' (contains / equals / in range), '~' (regex), '=' '<' '<=' '>' '>='.
+     * terms are joined by the implicit AND, 'or' / '|' & 'not' / '-' & parentheses are supported,
+     * bare words are matched as the case insensitive substrings of the task text.
+     */
+    enum class field_t { TEXT, PROJECT, DURATION, DATE, TIME, WEEKDAY, ROOT };
+    enum class op_t    { HAS, MATCH, EQ, LT, LE, GT, GE };
+
+    struct term_t {
+        field_t       field;
+        op_t          op;
+        std::string   str {};      // lowercase needle (TEXT & PROJECT)
+        std::int64_t  lo {0};      // numeric interval of the value (inclusive)
+        std::int64_t  hi {0};
+        std::uint8_t  wdays {0};   // weekday mask, bit 0 is Monday
+        std::optional<dfa::matcher_t> dm {};
+        std::optional<std::regex>     re {}; // fallback of the patterns unsupported by the DFA matcher
+    };
+
+    struct node_t {
+        enum kind_t { AND, OR, NOT, TERM } kind;
+        std::vector<node_t> kids {};
+        term_t term { field_t::TEXT, op_t::HAS };
+        int    cost {0}; // estimated evaluation cost per task
+    };
+
+    /**
+     * query -> AST -> predicate tree ordered by the estimated cost & selectivity.
+     * NOTE: match() is not const -> regex terms extend their DFA cache.
+     * filter() checks the set cancellation token once per 4096 tasks -> partial selection is returned
+     */
+    class filter_t {
+    public:
+        explicit filter_t(const std::string &query);
+
+        bool ok() const { return err.empty(); }
+        const std::string &error() const { return err; }
+
+        bool match(const ss::task_t &t);
+        ss::vtasks_t filter(const ss::vtasks_t &vtt, const std::atomic<bool> *cancel = nullptr);
+
+    private:
+        void optimize(const ss::vtasks_t &vtt);
+
+    private:
+        node_t root { node_t::AND };
+        std::string err {};
+    };
+}
+
+#endif // QUERY_HPP
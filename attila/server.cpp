@@ -0,0 +1,550 @@
+#include <algorithm> // stable_sort, lower_bound, upper_bound, max, min
+#include <chrono>
+#include <cstdint>   // uint16_t, uint32_t, uint64_t
+#include <ctime>     // time_t, localtime_r
+#include <filesystem>
+#include <future>    // async (client threads)
+#include <iostream>  // cerr
+#include <limits>
+#include <memory>    // shared_ptr
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>   // move, pair
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <cerrno>
+#include <csignal>   // signal, sig_atomic_t
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h> // timeval
+#include <sys/un.h>   // sockaddr_un
+#include <unistd.h>   // close, read
+#endif
+
+#include "server.hpp"
+#include "attila.hpp"
+#include "cal.hpp"     // ISO week calendar
+#include "exec.hpp"    // shared thread pool
+#include "mem.hpp"     // heap accounting per stage
+#include "query.hpp"   // query namespace
+#include "stats.hpp"
+#include "str.hpp"     // str namespace
+#include "tail.hpp"    // tail namespace
+
+namespace fs = std::filesystem;
+
+namespace
+{
+    constexpr int recv_timeout_sec { 5 };       // idle client releases its thread
+    constexpr std::size_t max_clients { 16 };   // connections served at once (own threads, not of the pool)
+
+    struct rollup_t {
+        std::uint64_t sum {0};
+        std::uint64_t count {0};
+        std::uint64_t max {0};
+        std::uint64_t min {0};
+    };
+
+    void add(rollup_t &r, std::uint64_t sec)
+    {
+        if (!r.count || sec < r.min)
+            r.min = sec;
+        if (sec > r.max)
+            r.max = sec;
+        r.sum += sec;
+        r.count++;
+    }
+
+    void add(rollup_t &r, const rollup_t &o)
+    {
+        if (!o.count)
+            return;
+        if (!r.count || o.min < r.min)
+            r.min = o.min;
+        r.max = std::max(r.max, o.max);
+        r.sum += o.sum;
+        r.count += o.count;
+    }
+
+    int day_of(std::time_t t)
+    {
+        std::tm tm {};
+        localtime_r(&t, &tm);
+        return cal::days_of(cal::date_t { tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday });
+    }
+
+    std::uint64_t spent(const ss::task_t &t)
+    {
+        return static_cast<std::uint64_t>(std::max<std::time_t>(t.hm_t.diff, 0));
+    }
+
+    using catalog_t = std::vector<std::pair<std::string, fs::file_time_type>>;
+
+    /**
+     * archive in memory: tasks ordered by the beginning, the day of each task & rollups per day.
+     * published as the immutable snapshot: requests answer from the snapshot they took,
+     * appends & reloads publish a new one (NOTE: raw text of the span is not kept)
+     */
+    struct state_t {
+        ss::span_t span {};
+        std::vector<int> days {};
+        int first_day {0};
+        std::vector<rollup_t> rollups {}; // by the day from first_day
+        std::uint64_t generation {0};
+
+        void index() {
+            std::stable_sort(span.vtt.begin(), span.vtt.end(), [](const auto &a, const auto &b) {
+                return a.hm_t.beg < b.hm_t.beg;
+            });
+            days.clear();
+            rollups.clear();
+            for (const auto &t : span.vtt)
+                days.push_back(day_of(t.hm_t.beg));
+            first_day = (days.empty()) ? 0 : days.front();
+            for (std::size_t i = 0; i < span.vtt.size(); i++)
+                roll(days[i], spent(span.vtt[i]));
+        }
+
+        /**
+         * appended tasks are usually the latest ones -> inserted at the end
+         */
+        void append(const ss::vtasks_t &tasks) {
+            if (span.vtt.empty()) {
+                span.vtt = tasks;
+                index();
+                return;
+            }
+            for (const auto &t : tasks) {
+                const int d = day_of(t.hm_t.beg);
+                if (d < first_day) {
+                    span.vtt.insert(span.vtt.end(), t);
+                    index(); // NOTE: before the first day -> rollups are shifted
+                    continue;
+                }
+                auto it = std::upper_bound(span.vtt.begin(), span.vtt.end(), t.hm_t.beg,
+                                           [](std::time_t beg, const ss::task_t &u) { return beg < u.hm_t.beg; });
+                days.insert(days.begin() + (it - span.vtt.begin()), d);
+                span.vtt.insert(it, t);
+                roll(d, spent(t));
+            }
+        }
+
+        /**
+         * tasks of the days [d_fr, d_to]
+         */
+        std::pair<std::size_t, std::size_t> range(int d_fr, int d_to) const {
+            const auto lo = std::lower_bound(days.begin(), days.end(), d_fr);
+            const auto hi = std::upper_bound(lo, days.end(), d_to);
+            return { static_cast<std::size_t>(lo - days.begin()), static_cast<std::size_t>(hi - days.begin()) };
+        }
+
+        rollup_t rolled(int d_fr, int d_to) const {
+            rollup_t r;
+            const int lo = std::max(d_fr, first_day) - first_day;
+            const int hi = std::min<long long>(d_to - static_cast<long long>(first_day),
+                                               static_cast<long long>(rollups.size()) - 1);
+            for (int d = lo; d <= hi; d++)
+                add(r, rollups[d]);
+            return r;
+        }
+
+    private:
+        void roll(int day, std::uint64_t sec) {
+            const std::size_t d = static_cast<std::size_t>(day - first_day);
+            if (d >= rollups.size())
+                rollups.resize(d + 1);
+            add(rollups[d], sec);
+        }
+    };
+
+    catalog_t catalog_of(const std::vector<std::string> &roots, const std::vector<tail::state_t> &tails)
+    {
+        catalog_t c;
+        for (const auto &root : roots) {
+            for (const auto &fpath : find_week_files(root)) {
+                if (std::any_of(tails.begin(), tails.end(), [&](const auto &t) { return t.fpath == fpath; }))
+                    continue; // NOTE: appends are read by its tail
+                std::error_code ec;
+                c.emplace_back(fpath, fs::last_write_time(fpath, ec));
+            }
+        }
+        return c;
+    }
+
+    /**
+     * files watched by the main loop (not shared with the clients):
+     * current week files of the roots are tailed, the rest of the week files is compared by mtime
+     */
+    struct watch_t {
+        std::vector<tail::state_t> tails {};
+        catalog_t catalog {};
+    };
+
+    struct loaded_t {
+        std::shared_ptr<state_t> st {}; // NOTE: generation is set when it is published
+        watch_t watch {};
+    };
+
+    loaded_t load(const std::vector<std::string> &roots)
+    {
+        auto st = std::make_shared<state_t>();
+        st->span = load_span(roots, "1970-01-01", cal::date_str(cal::today()));
+        loaded_t ld;
+        // tails continue where the files were read -> lines appended meanwhile are not lost
+        for (std::size_t i = 0; i < roots.size(); i++) {
+            const std::string fpath = find_last_week_file(roots[i]);
+            if (fpath.empty() || str::is_compressed(fpath))
+                continue;
+            ld.watch.tails.push_back(tail_after_span(st->span.fpaths, st->span.fsizes, fpath));
+            ld.watch.tails.back().root = static_cast<std::uint16_t>(i);
+        }
+        ld.watch.catalog = catalog_of(roots, ld.watch.tails);
+        // queries use the parsed tasks only -> raw text & its line offsets are released
+        st->span.content = std::string();
+        st->span.idx = lines::index_t();
+        st->index();
+        ld.st = std::move(st);
+        return ld;
+    }
+
+    void write_task(wire::writer_t &w, const ss::task_t &t)
+    {
+        w.i64(static_cast<std::int64_t>(t.hm_t.beg));
+        w.i64(static_cast<std::int64_t>(spent(t)));
+        w.u16(t.root);
+        w.u32(static_cast<std::uint32_t>(t.subt_t.size()));
+        w.str(t.dts);
+        w.str(t.text);
+    }
+
+    /**
+     * answer of the request from the snapshot of the state
+     */
+    std::string handle(const state_t &st, const wire::request_t &rq)
+    {
+        cal::date_t d {};
+        int d_fr = std::numeric_limits<int>::min();
+        int d_to = std::numeric_limits<int>::max();
+        if (!rq.fr.empty()) {
+            if (!cal::parse_date(rq.fr, d))
+                return wire::error("not valid date: '" + rq.fr + "' (YYYY-MM-DD)");
+            d_fr = cal::days_of(d);
+        }
+        if (!rq.to.empty()) {
+            if (!cal::parse_date(rq.to, d))
+                return wire::error("not valid date: '" + rq.to + "' (YYYY-MM-DD)");
+            d_to = cal::days_of(d);
+        }
+        if (d_to < d_fr)
+            std::swap(d_fr, d_to);
+
+        wire::writer_t w;
+        w.u8(static_cast<std::uint8_t>(wire::status_t::OK));
+        if (rq.op == wire::op_t::STATUS) {
+            w.u64(st.generation);
+            w.u64(st.span.fpaths.size());
+            w.u64(st.span.vtt.size());
+            w.u64(st.span.diag.total());
+            return w.frame();
+        }
+        const auto [lo, hi] = st.range(d_fr, d_to);
+        const ss::vtasks_t &vtt = st.span.vtt;
+        std::vector<std::size_t> selected;
+        if (!rq.query.empty() || rq.op != wire::op_t::STATS) {
+            const mem::scope_t mscope(mem::stage_t::FILTER);
+            query::filter_t qf(rq.query);
+            if (!qf.ok())
+                return wire::error("not valid query: " + qf.error());
+            for (std::size_t i = lo; i < hi; i++)
+                if (rq.query.empty() || qf.match(vtt[i]))
+                    selected.push_back(i);
+        }
+
+        switch (rq.op) {
+        case wire::op_t::STATS: {
+            rollup_t r;
+            if (rq.query.empty())
+                r = st.rolled(d_fr, d_to); // O(days) instead of O(tasks)
+            else
+                for (const std::size_t i : selected)
+                    add(r, spent(vtt[i]));
+            w.u64(r.sum);
+            w.u64((r.count) ? r.sum / r.count : 0);
+            w.u64(r.max);
+            w.u64(r.min);
+            w.u64(r.count);
+            break;
+        }
+        case wire::op_t::TASKS:
+            w.u32(static_cast<std::uint32_t>(selected.size()));
+            for (const std::size_t i : selected)
+                write_task(w, vtt[i]);
+            break;
+        case wire::op_t::MERGED: {
+            ss::vtasks_t sel;
+            sel.reserve(selected.size());
+            for (const std::size_t i : selected)
+                sel.push_back(vtt[i]);
+            const ss::vtasks_t merged = merge_tasks_by_text(sel);
+            w.u32(static_cast<std::uint32_t>(merged.size()));
+            for (const auto &t : merged)
+                write_task(w, t);
+            break;
+        }
+        case wire::op_t::STATUS:
+            break;
+        }
+        return w.frame();
+    }
+
+#if defined(__unix__) || defined(__APPLE__)
+    volatile std::sig_atomic_t stop { 0 };
+
+    void on_signal(int)
+    {
+        stop = 1;
+    }
+
+    bool recv_all(int fd, char *buf, std::size_t n)
+    {
+        while (n) {
+            const ssize_t r = ::read(fd, buf, n);
+            if (r < 0 && errno == EINTR)
+                continue;
+            if (r <= 0)
+                return false; // closed, timed out or failed
+            buf += r;
+            n -= static_cast<std::size_t>(r);
+        }
+        return true;
+    }
+
+    // peer gone -> send() fails with EPIPE instead of SIGPIPE (the signal disposition of the process is kept)
+#if defined(MSG_NOSIGNAL)
+    constexpr int send_flags { MSG_NOSIGNAL };
+#else
+    constexpr int send_flags { 0 }; // NOTE: SO_NOSIGPIPE of the socket instead (macOS)
+#endif
+
+    void no_sigpipe([[maybe_unused]] int fd)
+    {
+#if !defined(MSG_NOSIGNAL) && defined(SO_NOSIGPIPE)
+        const int on {1};
+        ::setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+    }
+
+    bool send_all(int fd, const std::string &s)
+    {
+        const char *buf = s.data();
+        std::size_t n = s.size();
+        while (n) {
+            const ssize_t r = ::send(fd, buf, n, send_flags);
+            if (r < 0 && errno == EINTR)
+                continue;
+            if (r <= 0)
+                return false;
+            buf += r;
+            n -= static_cast<std::size_t>(r);
+        }
+        return true;
+    }
+
+    /**
+     * frame of the peer -> its body
+     */
+    bool recv_frame(int fd, std::string &body)
+    {
+        char hdr[4];
+        if (!recv_all(fd, hdr, sizeof(hdr)))
+            return false;
+        wire::reader_t r(std::string_view(hdr, sizeof(hdr)));
+        const std::uint32_t size = r.u32();
+        if (size > wire::max_frame)
+            return false;
+        body.assign(size, '\0');
+        return recv_all(fd, body.data(), size);
+    }
+
+    bool socket_addr(const std::string &path, sockaddr_un &addr)
+    {
+        addr = {};
+        addr.sun_family = AF_UNIX;
+        if (path.empty() || path.size() >= sizeof(addr.sun_path))
+            return false;
+        path.copy(addr.sun_path, path.size());
+        return true;
+    }
+
+    /**
+     * requests of one client until it closes the connection (on its own thread:
+     * I/O threads of the pool are left to the reading of the week files by the reload)
+     */
+    void serve(int fd, std::mutex &mtx, const std::shared_ptr<const state_t> &st)
+    {
+        std::string body;
+        while (recv_frame(fd, body)) {
+            wire::request_t rq;
+            std::string answer;
+            if (!wire::decode(body, rq)) {
+                answer = wire::error("not valid request (protocol version " + std::to_string(wire::version) + ")");
+            } else {
+                std::shared_ptr<const state_t> snapshot;
+                {
+                    std::lock_guard<std::mutex> lk(mtx); // NOTE: only the pointer, not the query
+                    snapshot = st;
+                }
+                answer = handle(*snapshot, rq);
+            }
+            if (!send_all(fd, answer))
+                break;
+        }
+        ::close(fd);
+    }
+#endif
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+int server::run(const server::config_t &c)
+{
+    sockaddr_un addr;
+    if (!socket_addr(c.socket, addr)) {
+        std::cerr << "[Error]: not valid socket path: '" << c.socket << "'" << std::endl;
+        return 2;
+    }
+    const std::vector<std::string> roots = (c.roots.empty()) ? task_roots() : c.roots;
+    loaded_t ld = load(roots);
+    std::shared_ptr<const state_t> st = std::move(ld.st); // published snapshot
+    watch_t watch = std::move(ld.watch);
+    std::mutex mtx; // of the st pointer
+    std::cerr << "[Info]: " << st->span.vtt.size() << " tasks of " << st->span.fpaths.size() << " week files loaded\n";
+
+    const int lfd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    std::error_code ec;
+    if (fs::is_socket(c.socket, ec))
+        fs::remove(c.socket, ec); // left by the previous run
+    if (lfd < 0 || ::bind(lfd, reinterpret_cast<const sockaddr *>(&addr), sizeof(addr)) != 0
+            || ::listen(lfd, 16) != 0) {
+        std::cerr << "[Error]: cannot listen on the socket: '" << c.socket << "'" << std::endl;
+        if (lfd >= 0)
+            ::close(lfd);
+        return 1;
+    }
+    fs::permissions(c.socket, fs::perms::owner_read | fs::perms::owner_write, ec);
+    std::signal(SIGINT, on_signal);
+    std::signal(SIGTERM, on_signal);
+
+    std::vector<std::future<void>> clients;
+    exec::future_t<loaded_t> reloading;
+    std::uint64_t generation {0};
+    auto last_watch = std::chrono::steady_clock::now();
+    while (!stop) {
+        pollfd pfd { lfd, POLLIN, 0 };
+        if (::poll(&pfd, 1, 100) > 0 && (pfd.revents & POLLIN)) {
+            const int fd = ::accept(lfd, nullptr, nullptr);
+            if (fd >= 0) {
+                const timeval tv { recv_timeout_sec, 0 };
+                ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+                no_sigpipe(fd);
+                clients.erase(std::remove_if(clients.begin(), clients.end(), [](const auto &f) {
+                                                 return f.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+                                             }),
+                              clients.end());
+                if (clients.size() < max_clients) {
+                    clients.push_back(std::async(std::launch::async, serve, fd, std::ref(mtx), std::cref(st)));
+                } else {
+                    send_all(fd, wire::error("too many clients, try again later"));
+                    ::close(fd);
+                }
+            }
+        }
+        if (reloading.valid() && reloading.ready()) {
+            loaded_t fresh = reloading.get();
+            reloading = {};
+            watch = std::move(fresh.watch);
+            fresh.st->generation = ++generation; // NOTE: appends during the reload had newer generations
+            {
+                std::lock_guard<std::mutex> lk(mtx);
+                st = std::move(fresh.st);
+            }
+            std::cerr << "[Info]: reloaded, " << st->span.vtt.size() << " tasks\n";
+        }
+        const auto now = std::chrono::steady_clock::now();
+        if (now - last_watch < std::chrono::milliseconds(c.poll_ms))
+            continue;
+        last_watch = now;
+        // NOTE: tails & catalog are touched only by this thread.
+        // appends are applied during the reload too: the reloaded state has its own tails
+        // (continuing where its span was read) -> it replaces this state without losing or doubling the lines
+        bool changed = catalog_of(roots, watch.tails) != watch.catalog;
+        ss::vtasks_t appended;
+        diag::log_t appended_log(static_cast<std::uint32_t>(st->span.fpaths.size()), 0); // NOTE: line is not known
+        for (auto &t : watch.tails) {
+            std::string lines;
+            const tail::status_t status = tail::read(t, lines);
+            if (status == tail::status_t::rewritten) {
+                changed = true;
+            } else if (status == tail::status_t::appended) {
+                ss::vtasks_t tasks = parse_tasks(lines, &appended_log);
+                for (auto &task : tasks)
+                    task.root = t.root;
+                appended.insert(appended.end(), tasks.begin(), tasks.end());
+            }
+        }
+        if (!appended.empty() || appended_log.total()) {
+            // copy on write: requests in flight keep answering from their snapshot
+            auto next = std::make_shared<state_t>(*st);
+            next->span.diag.merge(appended_log);
+            next->append(appended);
+            next->generation = ++generation;
+            std::lock_guard<std::mutex> lk(mtx);
+            st = std::move(next);
+        }
+        if (changed && !reloading.valid()) // NOTE: the change during the reload is seen again after it
+            reloading = exec::async_on(exec::lane_t::BACKGROUND, load, std::cref(roots));
+    }
+    ::close(lfd);
+    fs::remove(c.socket, ec);
+    for (auto &f : clients)
+        f.wait(); // NOTE: idle clients are released by the receive timeout
+    if (reloading.valid())
+        reloading.wait();
+    return 0;
+}
+
+bool server::ask(const std::string &socket, const wire::request_t &rq, std::string &body, std::string &err)
+{
+    sockaddr_un addr;
+    if (!socket_addr(socket, addr)) {
+        err = "not valid socket path: '" + socket + "'";
+        return false;
+    }
+    const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || ::connect(fd, reinterpret_cast<const sockaddr *>(&addr), sizeof(addr)) != 0) {
+        err = "cannot connect to the daemon: '" + socket + "'";
+        if (fd >= 0)
+            ::close(fd);
+        return false;
+    }
+    no_sigpipe(fd);
+    const bool ok = send_all(fd, wire::encode(rq)) && recv_frame(fd, body);
+    ::close(fd);
+    if (!ok)
+        err = "no answer of the daemon: '" + socket + "'";
+    return ok;
+}
+#else
+int server::run(const server::config_t &)
+{
+    std::cerr << "[Error]: the query daemon needs Unix domain sockets" << std::endl;
+    return 2;
+}
+
+bool server::ask(const std::string &, const wire::request_t &, std::string &, std::string &err)
+{
+    err = "the query daemon needs Unix domain sockets";
+    return false;
+}
+#endif
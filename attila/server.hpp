@@ -0,0 +1,34 @@
+#ifndef SERVER_HPP
+#define SERVER_HPP
+
+#include <string>
+#include <vector>
+
+#include "wire.hpp" // binary protocol
+
+namespace server
+{
+    /**
+     * resident query daemon: the whole archive (week files of all roots up to today) is parsed once
+     * & kept in memory with the tasks ordered by the beginning, their days & rollups per day,
+     * queries (span, filter, stats, merge) are answered over the Unix domain socket (see wire.hpp).
+     * files are watched by polling: lines appended to the current week files are parsed & added
+     * in place, any other change (new, removed, rewritten week file) reloads the archive in the background
+     * (queries are answered from the previous state meanwhile).
+     */
+    struct config_t {
+        std::string socket {};             // path of the socket (replaced if it exists)
+        std::vector<std::string> roots {}; // none -> task_roots()
+        unsigned poll_ms { 1000 };         // interval of the file watching
+    };
+
+    int run(const server::config_t &c); // until SIGINT / SIGTERM, returns the exit code
+
+    /**
+     * client: sends one request & receives the response body (status & fields),
+     * false (& err) if the daemon does not answer
+     */
+    bool ask(const std::string &socket, const wire::request_t &rq, std::string &body, std::string &err);
+}
+
+#endif // SERVER_HPP
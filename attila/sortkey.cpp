@@ -0,0 +1,134 @@
+#include <algorithm> // sort, reverse, max, any_of, lexicographical_compare
+#include <cctype>    // tolower
+#include <cstddef>   // size_t
+#include <cstdint>   // uint32_t, uint64_t
+#include <ctime>     // time_t
+#include <numeric>   // iota
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "sortkey.hpp"
+#include "exec.hpp"    // shared thread pool
+#include "mem.hpp"     // heap accounting per stage
+
+namespace
+{
+    constexpr unsigned    digit_bits { 16 };
+    constexpr std::size_t buckets    { std::size_t {1} << digit_bits };
+    constexpr unsigned    npasses    { 64 / digit_bits };
+
+    bool iless(std::string_view a, std::string_view b)
+    {
+        return std::lexicographical_compare(a.begin(), a.end(), b.begin(), b.end(), [](char x, char y) {
+            return std::tolower(static_cast<unsigned char>(x)) < std::tolower(static_cast<unsigned char>(y));
+        });
+    }
+
+    /**
+     * rank of the string of each task among the distinct strings (case insensitive order),
+     * tasks without the string are ranked after all of them
+     */
+    template<typename Get>
+    std::vector<std::uint64_t> ranks(const ss::vtasks_t &vtt, Get get)
+    {
+        constexpr std::uint32_t none { UINT32_MAX };
+        std::unordered_map<std::string_view, std::uint32_t> ids;
+        std::vector<std::string_view> distinct;
+        std::vector<std::uint32_t> id(vtt.size());
+        for (std::size_t i = 0; i < vtt.size(); i++) {
+            const std::string *s = get(vtt[i]);
+            if (!s) {
+                id[i] = none;
+                continue;
+            }
+            const auto [it, fresh] = ids.try_emplace(*s, static_cast<std::uint32_t>(distinct.size()));
+            if (fresh)
+                distinct.push_back(*s);
+            id[i] = it->second;
+        }
+        std::vector<std::uint32_t> sorted(distinct.size());
+        std::iota(sorted.begin(), sorted.end(), 0);
+        std::sort(sorted.begin(), sorted.end(), [&](std::uint32_t a, std::uint32_t b) {
+            return iless(distinct[a], distinct[b]);
+        });
+        std::vector<std::uint64_t> rank_of(distinct.size());
+        for (std::size_t r = 0; r < sorted.size(); r++)
+            rank_of[sorted[r]] = r;
+        std::vector<std::uint64_t> k(vtt.size());
+        for (std::size_t i = 0; i < vtt.size(); i++)
+            k[i] = (id[i] == none) ? distinct.size() : rank_of[id[i]];
+        return k;
+    }
+}
+
+/**
+ * keys of the tasks: the numeric keys in one pass, the ranks of the projects & texts in parallel
+ */
+sortkey::keys_t sortkey::build(const ss::vtasks_t &vtt)
+{
+    const mem::scope_t mscope(mem::stage_t::ANALYZE);
+    auto projects = exec::async([&vtt] {
+        return ranks(vtt, [](const ss::task_t &t) { return (t.tproj.empty()) ? nullptr : &t.tproj.front(); });
+    });
+    auto texts = exec::async([&vtt] {
+        return ranks(vtt, [](const ss::task_t &t) { return &t.text; });
+    });
+    sortkey::keys_t keys;
+    std::vector<std::uint64_t> &duration = keys.k[static_cast<std::size_t>(by_t::DURATION) - 1];
+    std::vector<std::uint64_t> &start    = keys.k[static_cast<std::size_t>(by_t::START) - 1];
+    duration.resize(vtt.size());
+    start.resize(vtt.size());
+    for (std::size_t i = 0; i < vtt.size(); i++) {
+        duration[i] = static_cast<std::uint64_t>(std::max<std::time_t>(vtt[i].hm_t.diff, 0));
+        // signed epoch -> unsigned order
+        start[i] = static_cast<std::uint64_t>(vtt[i].hm_t.beg) ^ (std::uint64_t {1} << 63);
+    }
+    keys.k[static_cast<std::size_t>(by_t::PROJECT) - 1] = projects.get();
+    keys.k[static_cast<std::size_t>(by_t::TEXT) - 1]    = texts.get();
+    return keys;
+}
+
+/**
+ * indices of the tasks in the order of the key: histograms of all digits are counted in one pass
+ * over the keys, passes of the digits which are the same for all tasks are skipped
+ * (e.g. the high bits of the durations & epochs) -> usually 1-2 scatter passes
+ */
+std::vector<std::uint32_t> sortkey::order(const sortkey::keys_t &keys, sortkey::by_t by, bool desc)
+{
+    const std::size_t n = keys.size();
+    std::vector<std::uint32_t> idx(n);
+    std::iota(idx.begin(), idx.end(), 0);
+    if (by == by_t::FILE) {
+        if (desc)
+            std::reverse(idx.begin(), idx.end());
+        return idx;
+    }
+    const std::vector<std::uint64_t> &k = keys.k[static_cast<std::size_t>(by) - 1];
+    const std::uint64_t flip = (desc) ? ~std::uint64_t {0} : 0; // NOTE: stable -> ties stay in the file order
+    auto digit = [&](std::uint32_t i, unsigned pass) {
+        return static_cast<std::size_t>(((k[i] ^ flip) >> (pass * digit_bits)) & (buckets - 1));
+    };
+    std::vector<std::size_t> counts(npasses * buckets, 0);
+    for (std::uint32_t i = 0; i < n; i++)
+        for (unsigned p = 0; p < npasses; p++)
+            counts[p * buckets + digit(i, p)]++;
+
+    std::vector<std::uint32_t> tmp(n);
+    for (unsigned p = 0; p < npasses; p++) {
+        std::size_t *c = counts.data() + p * buckets;
+        if (std::any_of(c, c + buckets, [n](std::size_t x) { return x == n; }))
+            continue; // the same digit for all
+        std::size_t sum {0};
+        for (std::size_t b = 0; b < buckets; b++) {
+            const std::size_t x = c[b];
+            c[b] = sum;
+            sum += x;
+        }
+        for (const std::uint32_t i : idx)
+            tmp[c[digit(i, p)]++] = i;
+        idx.swap(tmp);
+    }
+    return idx;
+}
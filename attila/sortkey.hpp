@@ -0,0 +1,31 @@
+#ifndef SORTKEY_HPP
+#define SORTKEY_HPP
+
+#include <array>
+#include <cstddef> // size_t
+#include <cstdint> // uint8_t, uint32_t, uint64_t
+#include <vector>
+
+#include "structs.hpp" // ss namespace with struct defs
+
+namespace sortkey
+{
+    /**
+     * sort orders of the task views: the keys of every task are packed into fixed-width integers
+     * once per set of tasks (duration, start epoch, rank of the project & of the text among the distinct ones),
+     * each re-sort is then a stable LSD radix sort of the task indices by one key
+     * (no task_t is moved or compared, ties keep the order of the file).
+     */
+    enum class by_t : std::uint8_t { FILE, DURATION, START, PROJECT, TEXT };
+    constexpr std::size_t nkeys { 4 }; // FILE order needs no key
+
+    struct keys_t {
+        std::array<std::vector<std::uint64_t>, nkeys> k {}; // by by_t - 1
+        std::size_t size() const { return k[0].size(); }
+    };
+
+    sortkey::keys_t build(const ss::vtasks_t &vtt);
+    std::vector<std::uint32_t> order(const sortkey::keys_t &keys, sortkey::by_t by, bool desc);
+}
+
+#endif // SORTKEY_HPP
@@ -1,15 +1,22 @@
 #include "stats.hpp"
 #include "structs.hpp" // ss  namespace with struct defs
 #include "str.hpp"     // str namespace
+#include "neardup.hpp" // neardup namespace
+#include "mem.hpp"     // heap accounting per stage
+#include "exec.hpp"    // shared thread pool
 
 #include <iostream>  // cerr
 #include <sstream>   // ostringstream
 
 #include <algorithm> // erase/remove
 #include <cstddef>   // size_t
+#include <cstdint>   // int64_t
 #include <ctime>     // time_t
+#include <functional> // ref
 #include <set>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 
 #include <fmt/core.h>
@@ -35,6 +42,21 @@ const ss::stats_t calculate_stats(const ss::vtasks_t &vtt)
     return { avg, max, min, sum, nrecords };
 }
 
+/**
+ * stats of the union of two samples (used to update stats by the appended tasks),
+ * empty sample -> stats of the other one (its min of 0 would win & average divides by zero)
+ */
+const ss::stats_t add_stats(const ss::stats_t &a, const ss::stats_t &b)
+{
+    if (a.nrecords == 0)
+        return b;
+    if (b.nrecords == 0)
+        return a;
+    const std::size_t sum { a.sum + b.sum };
+    const std::size_t nrecords { a.nrecords + b.nrecords };
+    return { sum / nrecords, std::max(a.max, b.max), std::min(a.min, b.min), sum, nrecords };
+}
+
 const ss::stats_human_t calculate_stats_human(const ss::stats_t &t)
 {
     // convert size_t seconds into HH:MM spent time string
@@ -44,9 +66,154 @@ const ss::stats_human_t calculate_stats_human(const ss::stats_t &t)
     return { hm(t.avg), hm(t.max), hm(t.min), hm(t.sum), t.nrecords };
 }
 
+static constexpr std::int64_t day_min  { 24 * 60 };
+static constexpr std::int64_t week_min { 7 * day_min };
+
+/**
+ * accumulate tasks of the range into the difference array of the week minutes:
+ * +1 at the first minute of the task & -1 after its last minute (wrapped over Sunday -> Monday),
+ * => constant work per task without branches, regardless of buckets/midnights it crosses.
+ * whole weeks of the (very long) tasks are counted separately in laps.
+ */
+static void heatmap_partial(const ss::task_t *beg, const ss::task_t *end,
+                            std::vector<std::int64_t> &d, std::int64_t &laps)
+{
+    for (const ss::task_t *t = beg; t != end; ++t) {
+        const std::tm &tm = t->hm_t.tm_beg; // normalized by mktime -> tm_wday is set
+        const std::int64_t s = ((tm.tm_wday + 6) % 7) * day_min + tm.tm_hour * 60 + tm.tm_min;
+        const std::int64_t len = std::max<std::time_t>(t->hm_t.diff, 0) / 60;
+        const std::int64_t e = s + len % week_min;
+        const std::int64_t wrap = (e >= week_min);
+        laps += len / week_min;
+        d[s] += 1;
+        d[e - wrap * week_min] -= 1;
+        d[0] += wrap;
+    }
+}
+
+/**
+ * minutes spent per weekday & time of the day bucket (bucket_min must divide an hour).
+ * tasks are accumulated by chunks into per-thread partial difference arrays,
+ * which are reduced & integrated into minute occupancy at the end.
+ */
+const ss::heatmap_t calculate_heatmap(const ss::vtasks_t &vtt, std::size_t bucket_min)
+{
+    if (bucket_min == 0 || 60 % bucket_min != 0)
+        bucket_min = 60;
+    const std::size_t n = vtt.size();
+    const std::size_t threads_total = exec::workers();
+    const std::size_t nchunks = (threads_total < 2 || n < 10000) ? 1 : threads_total;
+    const std::size_t tpc = n / nchunks; // tasks per chunk (last chunk takes the remainder)
+
+    std::vector<std::vector<std::int64_t>> partials(nchunks, std::vector<std::int64_t>(week_min, 0));
+    std::vector<std::int64_t> laps(nchunks, 0);
+    std::vector<exec::future_t<void>> futures;
+    for (std::size_t c = 1; c < nchunks; c++) {
+        const ss::task_t *beg = vtt.data() + tpc * c;
+        const ss::task_t *end = (c + 1 == nchunks) ? vtt.data() + n : beg + tpc;
+        futures.push_back(exec::async(heatmap_partial,
+                                      beg, end, std::ref(partials[c]), std::ref(laps[c])));
+    }
+    heatmap_partial(vtt.data(), vtt.data() + ((nchunks == 1) ? n : tpc), partials[0], laps[0]);
+
+    std::vector<std::int64_t> &occ = partials[0];
+    std::int64_t whole { laps[0] };
+    for (std::size_t c = 1; c < nchunks; c++) {
+        futures[c - 1].get();
+        const std::vector<std::int64_t> &d = partials[c];
+        for (std::int64_t m = 0; m < week_min; m++)
+            occ[m] += d[m];
+        whole += laps[c];
+    }
+    // difference array -> number of tasks covering each minute of the week
+    std::int64_t run { whole };
+    for (std::int64_t m = 0; m < week_min; m++) {
+        run += occ[m];
+        occ[m] = run;
+    }
+
+    ss::heatmap_t hm { bucket_min, std::vector<std::size_t>(week_min / bucket_min, 0) };
+    for (std::size_t b = 0; b < hm.minutes.size(); b++) {
+        const std::int64_t *m = occ.data() + b * bucket_min;
+        std::int64_t sum {0};
+        for (std::size_t i = 0; i < bucket_min; i++)
+            sum += m[i];
+        hm.minutes[b] = static_cast<std::size_t>(sum);
+    }
+    return hm;
+}
+
+/**
+ * render heatmap as the text: row per weekday, shade per bucket & total spent per day
+ */
+const std::string heatmap_to_str(const ss::heatmap_t &hm)
+{
+    static constexpr const char *days[] { "Mon", "Tue", "Wed", "Thu", "Fri", "Sat", "Sun" };
+    static constexpr std::string_view shades { " .:-=+*#%@" };
+    const std::size_t nb = hm.buckets();
+    const std::size_t per_hour = 60 / hm.bucket_min;
+    const std::size_t cw = (3 + per_hour - 1) / per_hour; // cell width -> hour label fits
+    const std::size_t max = (hm.minutes.empty()) ? 0
+                          : *std::max_element(hm.minutes.begin(), hm.minutes.end());
+
+    std::string out { "    " };
+    for (std::size_t h = 0; h < 24; h++)
+        out += fmt::format("{:<{}}", fmt::format("{:02}", h), per_hour * cw);
+    out += "  spent\n";
+    for (std::size_t wd = 0; wd < 7; wd++) {
+        std::size_t sum {0};
+        out += fmt::format("{} ", days[wd]);
+        for (std::size_t b = 0; b < nb; b++) {
+            const std::size_t v = hm.minutes[wd * nb + b];
+            const std::size_t level = (max) ? (v * 9 + max - 1) / max : 0; // any work -> visible
+            out.append(cw, shades[level]);
+            sum += v;
+        }
+        out += fmt::format("  {:02}:{:02}\n", sum / 60, sum % 60);
+    }
+    out += fmt::format("\ncell: {} min, shades: '{}' up to {} min\n", hm.bucket_min, shades, max);
+    return out;
+}
+
+/**
+ * sum time spent of all sub-tasks & set new parameters of the main task,
+ * compose string with text indicating merged tasks into one main task
+ */
+static void merge_main_task(ss::task_t &main_task)
+{
+    if (main_task.subt_t.size() < 2) {
+        return; // skip -> this task does not have sub-tasks
+    }
+
+    std::time_t sec {0};
+    for (const auto &sub_task: main_task.subt_t) {
+        sec += sub_task.hm_t.diff;
+    }
+
+    const auto last = main_task.subt_t.rbegin();
+    // update hm_t struct values
+    main_task.hm_t.tm_end     = last->hm_t.tm_end;
+    main_task.hm_t.end        = last->hm_t.end;
+    main_task.hm_t.diff       = sec;
+    main_task.hm_t.date_to    = last->hm_t.date_to;
+    main_task.hm_t.time_to    = last->hm_t.time_to;
+    main_task.hm_t.time_spent = str::sec_to_tstr(sec);
+
+    // if first & last sub-task date differ -> only date strings without time: fr -> to
+    std::ostringstream out;
+    if (main_task.hm_t.date_fr == main_task.hm_t.date_to) {
+        out << "*M  (" << main_task.hm_t.date_fr << ") "
+            << main_task.hm_t.time_fr << " > " << main_task.hm_t.time_to;
+    } else {
+        out << "*M  (" << main_task.hm_t.date_fr << " >> " << main_task.hm_t.date_to << ")";
+    }
+    main_task.dts = out.str();
+}
+
 std::pair<const ss::vtasks_t, const std::string>
     merge_tasks(const ss::vtasks_t &vtt, const std::string &mulstr)
 {
+    const mem::scope_t mscope(mem::stage_t::MERGE);
     ss::vtasks_t v {vtt};
     // remove vector elements which text is not in multiline string
     // NOTE: (in case multiline string was filtered by the regex)
@@ -78,38 +245,83 @@ std::pair<const ss::vtasks_t, const std::string>
     // sum time spent of all sub-tasks & set new parameters of the main task
     // compose string with text indicating merged tasks into one main task
     for (auto &main_task: v) {
-        if (main_task.subt_t.size() < 2) {
-            continue; // skip -> this task does not have sub-tasks
-        }
+        merge_main_task(main_task);
+    }
 
-        std::time_t sec {0};
-        for (const auto &sub_task: main_task.subt_t) {
-            sec += sub_task.hm_t.diff;
-        }
+    return std::make_pair(v, str::tasks_to_mulstr(v));
+}
 
-        const auto last = main_task.subt_t.rbegin();
-        // update hm_t struct values
-        main_task.hm_t.tm_end     = last->hm_t.tm_end;
-        main_task.hm_t.end        = last->hm_t.end;
-        main_task.hm_t.diff       = sec;
-        main_task.hm_t.date_to    = last->hm_t.date_to;
-        main_task.hm_t.time_to    = last->hm_t.time_to;
-        main_task.hm_t.time_spent = str::sec_to_tstr(sec);
-
-        // if first & last sub-task date differ -> only date strings without time: fr -> to
-        std::ostringstream out;
-        if (main_task.hm_t.date_fr == main_task.hm_t.date_to) {
-            out << "*M  (" << main_task.hm_t.date_fr << ") "
-                << main_task.hm_t.time_fr << " > " << main_task.hm_t.time_to;
-        } else {
-            out << "*M  (" << main_task.hm_t.date_fr << " >> " << main_task.hm_t.date_to << ")";
-        }
-        main_task.dts = out.str();
+/**
+ * merge tasks with the same text like merge_tasks() (the main task is the first one),
+ * tasks are grouped by the hash of the text in one pass -> O(n) instead of O(n^2),
+ * no raw text to check the tasks against (all the tasks are merged).
+ * set cancellation token is checked once per 4096 tasks -> partially merged tasks are returned
+ */
+ss::vtasks_t merge_tasks_by_text(const ss::vtasks_t &vtt, const std::atomic<bool> *cancel)
+{
+    const mem::scope_t mscope(mem::stage_t::MERGE);
+    ss::vtasks_t v;
+    std::unordered_map<std::string_view, std::size_t> pos; // text -> position of its main task in v
+    pos.reserve(vtt.size());
+    for (std::size_t i = 0; i < vtt.size(); i++) {
+        if (cancel && (i & 0xfff) == 0 && cancel->load(std::memory_order_relaxed))
+            return v;
+        const ss::task_t &t = vtt[i];
+        const auto [it, first] = pos.try_emplace(t.text, v.size()); // NOTE: views of the texts in vtt
+        if (first)
+            v.push_back(t);
+        v[it->second].subt_t.insert(t);
     }
+    for (auto &main_task: v) {
+        merge_main_task(main_task);
+    }
+    return v;
+}
 
+/**
+ * merge near-duplicate tasks (similar words, see neardup namespace) the same way as merge_tasks(),
+ * the main task of each cluster is its first task
+ */
+std::pair<const ss::vtasks_t, const std::string>
+    merge_tasks_near(const ss::vtasks_t &vtt, double threshold)
+{
+    const mem::scope_t mscope(mem::stage_t::MERGE);
+    const std::vector<std::size_t> cluster = neardup::clusters(vtt, threshold);
+    ss::vtasks_t v;
+    std::vector<std::size_t> pos(vtt.size()); // position of the main task in v (by its index in vtt)
+    for (std::size_t i = 0; i < vtt.size(); i++) {
+        if (cluster[i] == i) {
+            pos[i] = v.size();
+            v.push_back(vtt[i]);
+        }
+        v[pos[cluster[i]]].subt_t.insert(vtt[i]); // NOTE: cluster[i] <= i -> main task already exists
+    }
+    for (auto &main_task: v) {
+        merge_main_task(main_task);
+    }
     return std::make_pair(v, str::tasks_to_mulstr(v));
 }
 
+/**
+ * merge appended tasks into already merged tasks (live mode),
+ * only the main tasks with the same text as the appended tasks are updated
+ */
+void merge_tasks_append(ss::vtasks_t &merged, const ss::vtasks_t &appended)
+{
+    const mem::scope_t mscope(mem::stage_t::MERGE);
+    for (const auto &task : appended) {
+        auto same_text = [&](const ss::task_t &main_task) { return main_task.text == task.text; };
+        auto it = std::find_if(merged.begin(), merged.end(), same_text);
+        if (it == merged.end()) {
+            merged.push_back(task);
+            merged.back().subt_t.insert(task); // main task is the first of its sub tasks
+            continue;
+        }
+        it->subt_t.insert(task);
+        merge_main_task(*it);
+    }
+}
+
 /**
  * auto create and populate groups by the tasks with unique project name
  */
@@ -1,13 +1,23 @@
 #ifndef STATS_HPP
 #define STATS_HPP
 
+#include <atomic> // atomic<bool> cancellation token
+
 #include "structs.hpp" // ss namespace with struct defs
 
 const ss::stats_t       calculate_stats(const ss::vtasks_t &vtt);
 const ss::stats_human_t calculate_stats_human(const ss::stats_t &stats_t);
+const ss::stats_t       add_stats(const ss::stats_t &a, const ss::stats_t &b);
+
+const ss::heatmap_t     calculate_heatmap(const ss::vtasks_t &vtt, std::size_t bucket_min = 60);
+const std::string       heatmap_to_str(const ss::heatmap_t &hm);
 
 std::pair<const ss::vtasks_t, const std::string>
     merge_tasks(const ss::vtasks_t &vtt, const std::string &mulstr);
+std::pair<const ss::vtasks_t, const std::string>
+    merge_tasks_near(const ss::vtasks_t &vtt, double threshold = 0.6);
+ss::vtasks_t merge_tasks_by_text(const ss::vtasks_t &vtt, const std::atomic<bool> *cancel = nullptr);
+void merge_tasks_append(ss::vtasks_t &merged, const ss::vtasks_t &appended);
 
 ss::sgroups_t auto_proj_groups(const ss::vtasks_t &vtt);
 
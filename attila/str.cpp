@@ -1,8 +1,10 @@
 #include <cstddef>   // size_t
+#include <cstdint>   // uint32_t
 #include <cstdlib>   // getenv
 #include <ctime>     // time_t
 
 #include <fstream>
+#include <functional> // cref
 #include <iostream>
 #include <sstream>
 
@@ -13,7 +15,15 @@
 
 #include <fmt/core.h>
 
+#ifdef ATTILA_HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef ATTILA_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
 #include "str.hpp"
+#include "exec.hpp" // shared thread pool
 
 using namespace std;
 
@@ -87,11 +97,103 @@ vector<string> str::split_on_words(const string &s)
     return str::resplit(s, sep_regex);
 }
 
+bool str::ends_with(const string &s, const string &suffix)
+{
+    return s.size() >= suffix.size() && s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+#ifdef ATTILA_HAVE_ZLIB
+/**
+ * decompress gzip file chunk by chunk straight into the content string
+ */
+static string gz_content(const string &fpath)
+{
+    string content;
+    gzFile gzf = gzopen(fpath.c_str(), "rb");
+    if (!gzf) {
+        cerr << "[Warning]: can not open gzip file: '" << fpath << "'\n";
+        return content;
+    }
+    gzbuffer(gzf, 128 * 1024);
+    char buf[64 * 1024];
+    int n;
+    while ((n = gzread(gzf, buf, sizeof(buf))) > 0)
+        content.append(buf, n);
+    if (n < 0) {
+        int errnum;
+        cerr << "[Warning]: gzip read error: '" << fpath << "' " << gzerror(gzf, &errnum) << '\n';
+    }
+    gzclose(gzf);
+    return content;
+}
+#endif
+
+#ifdef ATTILA_HAVE_ZSTD
+/**
+ * decompress zstd file chunk by chunk straight into the content string
+ */
+static string zst_content(const string &fpath)
+{
+    string content;
+    ifstream rfile(fpath, ios::in | ios::binary);
+    ZSTD_DStream *ds = ZSTD_createDStream();
+    ZSTD_initDStream(ds);
+    vector<char> in(ZSTD_DStreamInSize());
+    vector<char> out(ZSTD_DStreamOutSize());
+    while (rfile.read(in.data(), in.size()) || rfile.gcount()) {
+        ZSTD_inBuffer ib { in.data(), static_cast<size_t>(rfile.gcount()), 0 };
+        while (ib.pos < ib.size) {
+            ZSTD_outBuffer ob { out.data(), out.size(), 0 };
+            const size_t ret = ZSTD_decompressStream(ds, &ob, &ib);
+            if (ZSTD_isError(ret)) {
+                cerr << "[Warning]: zstd read error: '" << fpath << "' " << ZSTD_getErrorName(ret) << '\n';
+                ZSTD_freeDStream(ds);
+                return content;
+            }
+            content.append(out.data(), ob.pos);
+        }
+    }
+    ZSTD_freeDStream(ds);
+    return content;
+}
+#endif
+
+/**
+ * whether the file is compressed & can be decompressed by file_content()
+ */
+bool str::is_compressed(const string &fpath)
+{
+    return str::ends_with(fpath, ".gz") || str::ends_with(fpath, ".zst");
+}
+
+/**
+ * content of the file, compressed files (.gz, .zst) are transparently decompressed
+ */
 string str::file_content(const string &fpath)
 {
-    ifstream rfile(fpath, ios::in);
-    string  content((istreambuf_iterator<char>(rfile)),
-                    (istreambuf_iterator<char>()    ));
+    if (str::ends_with(fpath, ".gz")) {
+#ifdef ATTILA_HAVE_ZLIB
+        return gz_content(fpath);
+#else
+        cerr << "[Warning]: built without zlib, skipping: '" << fpath << "'\n";
+        return {};
+#endif
+    }
+    if (str::ends_with(fpath, ".zst")) {
+#ifdef ATTILA_HAVE_ZSTD
+        return zst_content(fpath);
+#else
+        cerr << "[Warning]: built without zstd, skipping: '" << fpath << "'\n";
+        return {};
+#endif
+    }
+    ifstream rfile(fpath, ios::in | ios::binary | ios::ate);
+    if (!rfile)
+        return {};
+    string content(static_cast<size_t>(rfile.tellg()), '\0');
+    rfile.seekg(0);
+    rfile.read(content.data(), content.size());
+    content.resize(rfile.gcount());
     return content;
 }
 
@@ -161,11 +263,87 @@ const string str::sec_to_tstr(const std::time_t &sec)
     return fmt::format("{:02}:{:02}", sec / 3600, sec % 3600 / 60);
 }
 
-const string str::tasks_to_mulstr(ss::vtasks_t &tasks)
+/**
+ * width of the HH:MM spent time field (hours are at least two digits)
+ */
+static size_t spent_width(std::time_t sec)
 {
-    std::ostringstream out;
-    for (const auto &t : tasks) {
-        out << t.dts << " <" << t.hm_t.time_spent << "> " << t.text << '\n';
+    size_t w = 2;
+    for (std::time_t h = sec / 3600; h >= 100; h /= 10)
+        w++;
+    return w + 3;
+}
+
+/**
+ * render lines [beg, end) into the preallocated buffer at the precomputed line offsets,
+ * line i is the task i or the task order[i]
+ */
+static void render_tasks(const ss::vtasks_t &tasks, const vector<uint32_t> *order, const vector<size_t> &offs,
+                         size_t beg, size_t end, char *buf)
+{
+    for (size_t i = beg; i < end; i++) {
+        const ss::task_t &t = tasks[(order) ? (*order)[i] : i];
+        const std::time_t sec = std::max<std::time_t>(t.hm_t.diff, 0);
+        char *p = buf + offs[i];
+        p = std::copy(t.dts.begin(), t.dts.end(), p);
+        *p++ = ' ';
+        *p++ = '<';
+        // fixed-width HH:MM -> digits are written from the end of the field
+        char *e = p + spent_width(sec);
+        std::time_t h = sec / 3600, m = sec % 3600 / 60;
+        e[-1] = static_cast<char>('0' + m % 10);
+        e[-2] = static_cast<char>('0' + m / 10);
+        e[-3] = ':';
+        for (char *d = e - 4; d >= p; d--, h /= 10)
+            *d = static_cast<char>('0' + h % 10);
+        p = e;
+        *p++ = '>';
+        *p++ = ' ';
+        p = std::copy(t.text.begin(), t.text.end(), p);
+        *p = '\n';
     }
-    return out.str();
+}
+
+/**
+ * render tasks as lines: "<dts> <HH:MM> <text>".
+ * exact size of each line is computed first (prefix sum -> offsets),
+ * then slices of the lines are rendered in parallel straight into the preallocated string.
+ */
+static string render_lines(const ss::vtasks_t &tasks, const vector<uint32_t> *order)
+{
+    const size_t n = (order) ? order->size() : tasks.size();
+    vector<size_t> offs(n + 1, 0);
+    for (size_t i = 0; i < n; i++) {
+        const ss::task_t &t = tasks[(order) ? (*order)[i] : i];
+        const std::time_t sec = std::max<std::time_t>(t.hm_t.diff, 0);
+        offs[i + 1] = offs[i] + t.dts.size() + 2 + spent_width(sec) + 2 + t.text.size() + 1;
+    }
+    string out(offs[n], '\0');
+    const size_t threads_total = exec::workers();
+    if (threads_total < 2 || n < 10000) {
+        render_tasks(tasks, order, offs, 0, n, out.data());
+        return out;
+    }
+    const size_t chunk = (n + threads_total - 1) / threads_total;
+    vector<exec::future_t<void>> futures;
+    for (size_t beg = chunk; beg < n; beg += chunk)
+        futures.push_back(exec::async(render_tasks, std::cref(tasks), order, std::cref(offs),
+                                      beg, std::min(beg + chunk, n), out.data()));
+    render_tasks(tasks, order, offs, 0, std::min(chunk, n), out.data());
+    for (auto &f : futures)
+        f.get();
+    return out;
+}
+
+const string str::tasks_to_mulstr(const ss::vtasks_t &tasks)
+{
+    return render_lines(tasks, nullptr);
+}
+
+/**
+ * tasks in the given order (indices into tasks, see sortkey.hpp)
+ */
+const string str::tasks_to_mulstr(const ss::vtasks_t &tasks, const vector<uint32_t> &order)
+{
+    return render_lines(tasks, &order);
 }
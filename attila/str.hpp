@@ -3,6 +3,7 @@
 
 #include <ctime>   // time_t
 #include <cstddef> // size_t
+#include <cstdint> // uint32_t
 #include <regex>
 #include <string>
 #include <vector>
@@ -24,12 +25,14 @@ namespace str
     string trim(const string &s);
 
     bool has_substr(const string &s, const string &substr);
+    bool ends_with(const string &s, const string &suffix);
 
     string sane_getenv(const string &envar);
 
     vector<string> resplit(const string &s, const regex &re);
     vector<string> split_on_words(const string &s);
 
+    bool   is_compressed(const string &fpath);
     string file_content(const string &fpath);
 
     const string lines_between(const vector<string> &lines, int beg_nl, int end_nl);
@@ -39,7 +42,8 @@ namespace str
     bool remove_lines_after (string &s, const string &substr, bool including_last);
 
     const string sec_to_tstr(const std::time_t &sec);
-    const string tasks_to_mulstr(ss::vtasks_t &tasks);
+    const string tasks_to_mulstr(const ss::vtasks_t &tasks);
+    const string tasks_to_mulstr(const ss::vtasks_t &tasks, const vector<uint32_t> &order);
 }
 
 #endif // STR_HPP
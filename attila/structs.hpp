@@ -3,11 +3,15 @@
 
 #include <atomic>  // atomic, fetch_add
 #include <cstddef> // size_t
+#include <cstdint> // uint16_t, uint32_t, uintmax_t
 #include <ctime>   // time_t
 #include <set>
 #include <string>
 #include <vector>
 
+#include "diag.hpp"  // parse diagnostics
+#include "lines.hpp" // line-offset table
+
 namespace ss
 {
     inline std::uint32_t getID() {
@@ -36,6 +40,7 @@ namespace ss
         std::vector<std::string> tproj;
         std::uint32_t id { ss::getID() };
         std::set<ss::task_t> subt_t {};
+        std::uint16_t root { 0 }; // root ID (index of the task directory in $POMODORO_DIRS)
     };
 
     inline bool operator<(const ss::task_t &lhs, const ss::task_t &rhs) {
@@ -45,6 +50,15 @@ namespace ss
     using vtasks_t = std::vector<ss::task_t>;
     using stasks_t = std::set<ss::task_t>;
 
+    struct span_t {
+        std::string    content; // concatenated text of the date span
+        ss::vtasks_t   vtt;     // tasks parsed from the content
+        lines::index_t idx;     // line-offset table of the content
+        std::vector<std::string> fpaths; // week files of the span (of all roots)
+        std::vector<std::uintmax_t> fsizes; // bytes read of each week file (before the lines out of the span are removed)
+        diag::log_t    diag;    // lines of the week files which are not tasks
+    };
+
     struct stats_t {
         const std::size_t avg;
         const std::size_t max;
@@ -53,6 +67,17 @@ namespace ss
         const std::size_t nrecords;
     };
 
+    /**
+     * minutes spent per weekday (rows: Mon..Sun) & time of the day bucket (columns)
+     * minutes[wday * buckets() + bucket]
+     */
+    struct heatmap_t {
+        std::size_t bucket_min { 60 };       // bucket width in minutes: 60 -> 7x24, 15 -> 7x96
+        std::vector<std::size_t> minutes {};
+
+        std::size_t buckets() const { return 24 * 60 / bucket_min; }
+    };
+
     struct stats_human_t {
         const std::string avg;
         const std::string max;
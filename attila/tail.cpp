@@ -0,0 +1,101 @@
+#include <algorithm> // min
+#include <cstdint>   // uintmax_t
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <system_error>
+#include <utility>   // move
+
+#include "tail.hpp"
+
+namespace fs = std::filesystem;
+
+namespace
+{
+    constexpr std::size_t guard_size { 64 };   // bytes compared to detect the rewrite
+
+    std::string read_range(std::ifstream &rfile, std::uintmax_t beg, std::uintmax_t end)
+    {
+        std::string buf(end - beg, '\0');
+        rfile.clear();
+        rfile.seekg(beg);
+        rfile.read(buf.data(), buf.size());
+        buf.resize(rfile.gcount());
+        return buf;
+    }
+
+    void set_guard(tail::state_t &t, const std::string &consumed)
+    {
+        t.guard += consumed;
+        if (t.guard.size() > guard_size)
+            t.guard.erase(0, t.guard.size() - guard_size);
+    }
+}
+
+/**
+ * start tailing the file at its end
+ */
+tail::state_t tail::init(const std::string &fpath)
+{
+    std::error_code ec;
+    const std::uintmax_t size = fs::file_size(fpath, ec);
+    return tail::init(fpath, (ec) ? 0 : size);
+}
+
+/**
+ * start tailing the file after its first consumed bytes (read by the initial load),
+ * including the last line without '\n' (partial -> its '\n' is expected first, not the line again).
+ * NOTE: the file shorter than consumed is reported as rewritten by the first read
+ */
+tail::state_t tail::init(const std::string &fpath, std::uintmax_t consumed)
+{
+    tail::state_t t {};
+    t.fpath  = fpath;
+    t.offset = consumed;
+    if (consumed == 0)
+        return t;
+    std::ifstream rfile(fpath, std::ios::in | std::ios::binary);
+    const std::uintmax_t beg = consumed - std::min<std::uintmax_t>(consumed, guard_size);
+    const std::string chunk = read_range(rfile, beg, consumed);
+    t.partial = !chunk.empty() && chunk.back() != '\n';
+    set_guard(t, chunk);
+    return t;
+}
+
+/**
+ * read complete lines appended to the file since the last read
+ */
+tail::status_t tail::read(tail::state_t &t, std::string &appended)
+{
+    appended.clear();
+    std::error_code ec;
+    const std::uintmax_t size = fs::file_size(t.fpath, ec);
+    if (ec || size < t.offset)
+        return tail::status_t::rewritten; // removed or truncated
+    std::ifstream rfile(t.fpath, std::ios::in | std::ios::binary);
+    if (!rfile)
+        return tail::status_t::rewritten;
+    // already consumed bytes must stay the same -> otherwise the file was rewritten
+    if (read_range(rfile, t.offset - t.guard.size(), t.offset) != t.guard)
+        return tail::status_t::rewritten;
+    if (size == t.offset)
+        return tail::status_t::unchanged;
+    std::string chunk = read_range(rfile, t.offset, size);
+    if (t.partial) {
+        // the partial line was parsed as it was -> only its '\n' may follow, anything else changed the line
+        if (chunk.empty() || chunk.front() != '\n')
+            return tail::status_t::rewritten;
+        t.partial = false;
+        t.offset += 1;
+        set_guard(t, "\n");
+        chunk.erase(0, 1);
+    }
+    const std::size_t nl = chunk.rfind('\n');
+    if (nl == std::string::npos)
+        return tail::status_t::unchanged; // last line is not complete yet
+    chunk.resize(nl + 1);
+    t.offset += chunk.size();
+    set_guard(t, chunk);
+    appended = std::move(chunk);
+    return tail::status_t::appended;
+}
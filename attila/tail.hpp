@@ -0,0 +1,31 @@
+#ifndef TAIL_HPP
+#define TAIL_HPP
+
+#include <cstdint> // uintmax_t, uint16_t
+#include <string>
+
+namespace tail
+{
+    /**
+     * position in the growing file up to which its complete lines were already consumed
+     */
+    struct state_t {
+        std::string   fpath;
+        std::uintmax_t offset {0}; // just after the '\n' of the last consumed line
+        std::string   guard;       // last consumed bytes (to detect the rewrite of the file)
+        bool partial {false};      // last consumed line has no '\n' yet (parsed by the initial load)
+        std::uint16_t root {0};    // root ID of the tasks in the file
+    };
+
+    enum class status_t {
+        unchanged, // nothing new (or only incomplete last line)
+        appended,  // new complete lines were appended
+        rewritten  // file was truncated or rewritten (or the partial line was changed) -> full rescan is required
+    };
+
+    tail::state_t  init(const std::string &fpath); // at the end of the file
+    tail::state_t  init(const std::string &fpath, std::uintmax_t consumed); // after the bytes already read
+    tail::status_t read(tail::state_t &t, std::string &appended);
+}
+
+#endif // TAIL_HPP
@@ -0,0 +1,214 @@
+#include <algorithm> // min, max, partial_sort
+#include <cstddef>   // size_t
+#include <ctime>     // time_t
+#include <functional>
+#include <queue>     // priority_queue
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>   // move, pair
+#include <vector>
+
+#include <fmt/core.h>
+
+#include "topk.hpp"
+#include "structs.hpp" // ss namespace with struct defs
+#include "exec.hpp"    // shared thread pool
+
+namespace
+{
+    constexpr std::size_t par_min { 10000 }; // reduce smaller vectors in one thread
+
+    struct agg_t {
+        std::size_t sec   {0};
+        std::size_t count {0};
+        std::size_t first {0}; // index of the first task of the group -> stable order of ties
+    };
+
+    using aggs_t = std::unordered_map<std::string_view, agg_t>;
+
+    /**
+     * reduce [beg, end) chunks of n elements in parallel, results are in the order of chunks
+     */
+    template<typename R, typename F>
+    std::vector<R> map_chunks(std::size_t n, F &&fn)
+    {
+        const std::size_t threads_total = exec::workers();
+        const std::size_t nchunks = (threads_total < 2 || n < par_min) ? 1 : threads_total;
+        const std::size_t chunk = (n + nchunks - 1) / nchunks;
+        if (nchunks == 1)
+            return { fn(std::size_t {0}, n) };
+        std::vector<exec::future_t<R>> futures;
+        for (std::size_t beg = 0; beg < n; beg += chunk)
+            futures.push_back(exec::async(fn, beg, std::min(beg + chunk, n)));
+        std::vector<R> out;
+        out.reserve(futures.size());
+        for (auto &f : futures)
+            out.push_back(f.get());
+        return out;
+    }
+
+    /**
+     * keep k best of the candidates pushed one by one (top() of the heap is the worst kept one)
+     */
+    template<typename T, typename Better>
+    class bounded_t {
+    public:
+        bounded_t(std::size_t k, Better better) : k(k), better(better), heap(better) {}
+
+        void push(const T &v) {
+            if (heap.size() < k) {
+                heap.push(v);
+            } else if (k && better(v, heap.top())) {
+                heap.pop();
+                heap.push(v);
+            }
+        }
+
+        std::vector<T> take() {
+            std::vector<T> out;
+            out.reserve(heap.size());
+            for (; !heap.empty(); heap.pop())
+                out.push_back(heap.top());
+            return out;
+        }
+
+    private:
+        std::size_t k;
+        Better better;
+        std::priority_queue<T, std::vector<T>, Better> heap;
+    };
+
+    template<typename T, typename Better>
+    std::vector<T> best_k(std::vector<T> &&cands, std::size_t k, Better better)
+    {
+        const std::size_t n = std::min(k, cands.size());
+        std::partial_sort(cands.begin(), cands.begin() + n, cands.end(), better);
+        cands.resize(n);
+        return std::move(cands);
+    }
+
+    /**
+     * sum time spent & count tasks per key (per chunk, then merged) & select k best groups
+     */
+    template<typename Key, typename Better>
+    std::vector<topk::group_t> top_groups(const ss::vtasks_t &vtt, std::size_t k, Key key, Better better)
+    {
+        if (vtt.empty() || k == 0)
+            return {};
+        std::vector<aggs_t> partials = map_chunks<aggs_t>(vtt.size(), [&](std::size_t beg, std::size_t end) {
+            aggs_t aggs;
+            for (std::size_t i = beg; i < end; i++) {
+                const std::string_view kv = key(vtt[i]);
+                if (kv.empty())
+                    continue;
+                auto [it, inserted] = aggs.try_emplace(kv, agg_t { 0, 0, i });
+                it->second.sec += static_cast<std::size_t>(std::max<std::time_t>(vtt[i].hm_t.diff, 0));
+                it->second.count++;
+            }
+            return aggs;
+        });
+        aggs_t &aggs = partials[0];
+        for (std::size_t c = 1; c < partials.size(); c++) {
+            for (const auto &[kv, a] : partials[c]) {
+                auto [it, inserted] = aggs.try_emplace(kv, a);
+                if (inserted)
+                    continue;
+                it->second.sec   += a.sec;
+                it->second.count += a.count;
+                it->second.first  = std::min(it->second.first, a.first);
+            }
+        }
+        using entry_t = std::pair<std::string_view, agg_t>;
+        bounded_t<entry_t, Better> heap(k, better);
+        for (const auto &e : aggs)
+            heap.push(e);
+        std::vector<entry_t> best = best_k(heap.take(), k, better);
+        std::vector<topk::group_t> groups;
+        groups.reserve(best.size());
+        for (const auto &[kv, a] : best)
+            groups.push_back({ std::string(kv), a.sec, a.count });
+        return groups;
+    }
+
+    std::string hm(std::size_t sec)
+    {
+        return fmt::format("{:02}:{:02}", sec / 3600, sec % 3600 / 60);
+    }
+}
+
+/**
+ * indices of the k longest tasks (longest first, earlier task first on ties)
+ */
+std::vector<std::size_t> topk::longest(const ss::vtasks_t &vtt, std::size_t k)
+{
+    if (vtt.empty() || k == 0)
+        return {};
+    using hit_t = std::pair<std::time_t, std::size_t>; // duration & index of the task
+    auto better = [](const hit_t &a, const hit_t &b) {
+        return a.first > b.first || (a.first == b.first && a.second < b.second);
+    };
+    using chunk_t = std::vector<hit_t>;
+    std::vector<chunk_t> partials = map_chunks<chunk_t>(vtt.size(), [&](std::size_t beg, std::size_t end) {
+        bounded_t<hit_t, decltype(better)> heap(k, better);
+        for (std::size_t i = beg; i < end; i++)
+            heap.push({ vtt[i].hm_t.diff, i });
+        return heap.take();
+    });
+    chunk_t hits;
+    for (auto &p : partials)
+        hits.insert(hits.end(), p.begin(), p.end());
+    hits = best_k(std::move(hits), k, better);
+    std::vector<std::size_t> out;
+    out.reserve(hits.size());
+    for (const auto &h : hits)
+        out.push_back(h.second);
+    return out;
+}
+
+/**
+ * projects with the most time spent (first project of the task -> [nvim][lsp] is nvim)
+ */
+std::vector<topk::group_t> topk::projects(const ss::vtasks_t &vtt, std::size_t k)
+{
+    auto key = [](const ss::task_t &t) -> std::string_view {
+        return (t.tproj.empty()) ? std::string_view {} : std::string_view { t.tproj[0] };
+    };
+    auto better = [](const auto &a, const auto &b) {
+        return a.second.sec > b.second.sec || (a.second.sec == b.second.sec && a.second.first < b.second.first);
+    };
+    return top_groups(vtt, k, key, better);
+}
+
+/**
+ * most frequent task texts (more time spent first on ties)
+ */
+std::vector<topk::group_t> topk::texts(const ss::vtasks_t &vtt, std::size_t k)
+{
+    auto key = [](const ss::task_t &t) -> std::string_view { return t.text; };
+    auto better = [](const auto &a, const auto &b) {
+        if (a.second.count != b.second.count)
+            return a.second.count > b.second.count;
+        return a.second.sec > b.second.sec || (a.second.sec == b.second.sec && a.second.first < b.second.first);
+    };
+    return top_groups(vtt, k, key, better);
+}
+
+/**
+ * top-K tables as the text (for the UI & the batch mode)
+ */
+std::string topk::report(const ss::vtasks_t &vtt, std::size_t k)
+{
+    std::string out { fmt::format("longest tasks (top {}):\n", k) };
+    for (const std::size_t i : topk::longest(vtt, k)) {
+        const ss::task_t &t = vtt[i];
+        out += fmt::format("  {}  {} {}\n", hm(t.hm_t.diff), t.dts, t.text);
+    }
+    out += fmt::format("\nmost time per project (top {}):\n", k);
+    for (const auto &g : topk::projects(vtt, k))
+        out += fmt::format("  {}  {:>5}  {}\n", hm(g.sec), g.count, g.key);
+    out += fmt::format("\nmost frequent tasks (top {}):\n", k);
+    for (const auto &g : topk::texts(vtt, k))
+        out += fmt::format("  {:>5}  {}  {}\n", g.count, hm(g.sec), g.key);
+    return out;
+}
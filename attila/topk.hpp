@@ -0,0 +1,33 @@
+#ifndef TOPK_HPP
+#define TOPK_HPP
+
+#include <cstddef> // size_t
+#include <string>
+#include <vector>
+
+#include "structs.hpp" // ss namespace with struct defs
+
+namespace topk
+{
+    /**
+     * top-K operators over the parsed tasks: chunks of tasks are reduced in parallel
+     * into bounded heaps (or partial aggregates), which are merged & partially sorted at the end
+     * -> O(n log k) without materializing a sorted copy of the tasks.
+     * NOTE: a pass of its own over the parsed tasks, not fed by the parsing of the week files:
+     *       the tables are built for the selected tasks (filter) as well as for the whole span
+     *       & the pass is small compared to the parsing (chunks of the tasks are reduced in parallel)
+     */
+    struct group_t {
+        std::string key;       // project name / task text
+        std::size_t sec;       // total time spent
+        std::size_t count;     // number of tasks
+    };
+
+    std::vector<std::size_t>   longest(const ss::vtasks_t &vtt, std::size_t k);  // task indices
+    std::vector<topk::group_t> projects(const ss::vtasks_t &vtt, std::size_t k); // most time spent
+    std::vector<topk::group_t> texts(const ss::vtasks_t &vtt, std::size_t k);    // most frequent
+
+    std::string report(const ss::vtasks_t &vtt, std::size_t k);
+}
+
+#endif // TOPK_HPP
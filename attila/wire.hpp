@@ -0,0 +1,146 @@
+#ifndef WIRE_HPP
+#define WIRE_HPP
+
+#include <cstddef> // size_t
+#include <cstdint> // uint8_t, uint16_t, uint32_t, uint64_t, int64_t
+#include <string>
+#include <string_view>
+
+namespace wire
+{
+    /**
+     * compact binary protocol of the query daemon (see server.hpp), little endian:
+     *   frame:    u32 size of the body, body
+     *   request:  u8 version, u8 op, str from, str to, str query   (str: u32 size, bytes)
+     *   response: u8 status, then by the status & op:
+     *     ERROR          str message
+     *     TASKS, MERGED  u32 count, per task: i64 beg, i64 spent (sec), u16 root, u32 subtasks, str dts, str text
+     *     STATS          u64 sum, avg, max, min (sec), u64 tasks
+     *     STATUS         u64 generation (reloads & appends), u64 files, u64 tasks, u64 skipped lines
+     * dates are YYYY-MM-DD (inclusive), empty query selects all tasks of the span.
+     */
+    constexpr std::uint8_t  version   { 1 };
+    constexpr std::uint32_t max_frame { 1u << 30 };
+
+    enum class op_t : std::uint8_t { STATUS, TASKS, STATS, MERGED };
+    enum class status_t : std::uint8_t { OK, ERROR };
+
+    struct request_t {
+        wire::op_t  op { op_t::STATUS };
+        std::string fr {};
+        std::string to {};
+        std::string query {};
+    };
+
+    class writer_t {
+    public:
+        void u8 (std::uint8_t v)  { buf.push_back(static_cast<char>(v)); }
+        void u16(std::uint16_t v) { put(v, 2); }
+        void u32(std::uint32_t v) { put(v, 4); }
+        void u64(std::uint64_t v) { put(v, 8); }
+        void i64(std::int64_t v)  { put(static_cast<std::uint64_t>(v), 8); }
+        void str(std::string_view s) {
+            u32(static_cast<std::uint32_t>(s.size()));
+            buf.append(s.data(), s.size());
+        }
+        /**
+         * body prefixed by its size
+         */
+        std::string frame() const {
+            writer_t w;
+            w.u32(static_cast<std::uint32_t>(buf.size()));
+            return w.buf + buf;
+        }
+        const std::string &body() const { return buf; }
+
+    private:
+        void put(std::uint64_t v, std::size_t n) {
+            for (std::size_t i = 0; i < n; i++)
+                buf.push_back(static_cast<char>((v >> (8 * i)) & 0xff));
+        }
+
+    private:
+        std::string buf {};
+    };
+
+    /**
+     * reads the fields of the body, ok() is false after reading past its end
+     */
+    class reader_t {
+    public:
+        explicit reader_t(std::string_view body) : buf(body) {}
+
+        bool ok() const { return good; }
+        bool done() const { return pos == buf.size(); }
+
+        std::uint8_t  u8()  { return static_cast<std::uint8_t>(get(1)); }
+        std::uint16_t u16() { return static_cast<std::uint16_t>(get(2)); }
+        std::uint32_t u32() { return static_cast<std::uint32_t>(get(4)); }
+        std::uint64_t u64() { return get(8); }
+        std::int64_t  i64() { return static_cast<std::int64_t>(get(8)); }
+        std::string   str() {
+            const std::uint32_t n = u32();
+            if (!good || buf.size() - pos < n) {
+                good = false;
+                return {};
+            }
+            std::string s(buf.substr(pos, n));
+            pos += n;
+            return s;
+        }
+
+    private:
+        std::uint64_t get(std::size_t n) {
+            if (!good || buf.size() - pos < n) {
+                good = false;
+                return 0;
+            }
+            std::uint64_t v {0};
+            for (std::size_t i = 0; i < n; i++)
+                v |= static_cast<std::uint64_t>(static_cast<unsigned char>(buf[pos + i])) << (8 * i);
+            pos += n;
+            return v;
+        }
+
+    private:
+        std::string_view buf;
+        std::size_t pos {0};
+        bool good {true};
+    };
+
+    inline std::string encode(const wire::request_t &rq)
+    {
+        wire::writer_t w;
+        w.u8(version);
+        w.u8(static_cast<std::uint8_t>(rq.op));
+        w.str(rq.fr);
+        w.str(rq.to);
+        w.str(rq.query);
+        return w.frame();
+    }
+
+    inline bool decode(std::string_view body, wire::request_t &rq)
+    {
+        wire::reader_t r(body);
+        if (r.u8() != version)
+            return false;
+        const std::uint8_t op = r.u8();
+        if (op > static_cast<std::uint8_t>(op_t::MERGED))
+            return false;
+        rq.op    = static_cast<wire::op_t>(op);
+        rq.fr    = r.str();
+        rq.to    = r.str();
+        rq.query = r.str();
+        return r.ok() && r.done();
+    }
+
+    inline std::string error(std::string_view message)
+    {
+        wire::writer_t w;
+        w.u8(static_cast<std::uint8_t>(status_t::ERROR));
+        w.str(message);
+        return w.frame();
+    }
+}
+
+#endif // WIRE_HPP